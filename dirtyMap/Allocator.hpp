@@ -5,8 +5,13 @@
 #include <cstdint>
 #include <cstddef>
 #include <utility>
+#include <cstring>
+#include <type_traits>
 
+#include "src/Allocator/aligned.hpp"
+#include "src/Allocator/relocate.hpp"
 #include "src/Allocator/pools.hpp"
+#include "src/Allocator/usage.hpp"
 #include "src/Allocator/allocators.hpp"
 
 #endif //FYP_MAPS_ALLOCATOR_HPP
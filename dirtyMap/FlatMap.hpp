@@ -0,0 +1,14 @@
+
+#ifndef FYP_MAPS_FLATMAP_HPP
+#define FYP_MAPS_FLATMAP_HPP
+
+#include <cstdint>        // int8_t, uint32_t
+#include <algorithm>      // min
+#include <utility>        // pair, move
+#include <functional>     // hash
+
+#include "src/FlatMap/control.hpp"
+#include "src/FlatMap/iterators.hpp"
+#include "src/FlatMap/flat_map.hpp"
+
+#endif //FYP_MAPS_FLATMAP_HPP
@@ -5,9 +5,21 @@
 #include <cstdint>        // uintptr_t
 #include <utility>        // pair, move
 #include <functional>     // hash
+#include <type_traits>    // conditional, integral_constant
 
+#include "src/HashMap/hash.hpp"
 #include "src/HashMap/bucket.hpp"
+#include "src/HashMap/occupancy.hpp"
 #include "src/HashMap/iterators.hpp"
+#include "src/HashMap/bucket_group.hpp"
+#include "src/HashMap/bucket_inline.hpp"
+#include "src/HashMap/small_store.hpp"
+#include "src/HashMap/growth.hpp"
+#include "src/HashMap/directory.hpp"
+#include "src/HashMap/statistics.hpp"
+#include "src/HashMap/trace.hpp"
+#include "src/HashMap/policies.hpp"
+#include "src/HashMap/memory_usage.hpp"
 #include "src/HashMap/hash_map.hpp"
 
 #endif //FYP_MAPS_HASHMAP_HPP
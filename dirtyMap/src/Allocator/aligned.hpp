@@ -0,0 +1,60 @@
+
+#ifndef FYP_MAPS_ALIGNED_HPP
+#define FYP_MAPS_ALIGNED_HPP
+
+#include <cstddef>    // max_align_t
+#include <cstdlib>    // posix_memalign, free
+#include <new>        // bad_alloc
+
+namespace drt {
+namespace drtx {
+
+    /**
+     * Minimal std::allocator replacement that honours alignof(T). Before
+     * C++17 operator new ignores over-alignment, so a vector of cache-line
+     * aligned buckets would otherwise straddle lines.
+     */
+    template<typename T>
+    struct aligned_allocator {
+        using value_type = T;
+
+        aligned_allocator() = default;
+
+        template<typename U>
+        aligned_allocator(const aligned_allocator<U>&) noexcept { }
+
+        T* allocate(size_t n) {
+            if (alignof(T) <= alignof(std::max_align_t)) {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+
+            void *p = nullptr;
+            if (posix_memalign(&p, alignof(T), n * sizeof(T)) != 0) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(p);
+        }
+
+        void deallocate(T *p, size_t) noexcept {
+            if (alignof(T) <= alignof(std::max_align_t)) {
+                ::operator delete(p);
+            } else {
+                free(p);
+            }
+        }
+
+        template<typename U>
+        bool operator==(const aligned_allocator<U>&) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const aligned_allocator<U>&) const noexcept {
+            return false;
+        }
+    };
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_ALIGNED_HPP
@@ -3,38 +3,55 @@
 #define FYP_MAPS_ALLOCATORS_HPP
 
 #include <vector>
+#include <algorithm>    // sort
+#include <cassert>
+#include <functional>   // less
 
 namespace drt {
 
 namespace drtx {
 
-    template<typename T, typename obj_count>
+    template<typename T, typename obj_count, typename Pools, typename Sizing>
     struct DtIterator;
 }
 
-    template<typename T, typename obj_count = drtx::buddy_mb_count<T>>
+    /**
+     * Allocator that hands out blocks from a growing list of pools.
+     *
+     * @tparam T         The type of object to store.
+     * @tparam obj_count The number of T objects per pool.
+     * @tparam Pools     Pool policy: stacked_pools (compacting) or
+     *                   stable_pools (objects never move).
+     * @tparam Sizing    Capacity of each new pool: fixed_pool_size (always
+     *                   obj_count), pool_bytes or geometric_pool_size.
+     */
+    template<typename T, typename obj_count = drtx::buddy_mb_count<T>, typename Pools = stacked_pools,
+            typename Sizing = fixed_pool_size>
     class DtPoolAllocator {
 
     public:
-        using pool_type  = StackedPool<T, obj_count>;
-        using iterator   = drtx::DtIterator<T, obj_count>;
+        using pool_type  = typename Pools::template pool<T, obj_count>;
+        using iterator   = drtx::DtIterator<T, obj_count, Pools, Sizing>;
 
     private:
         using v_iterator = typename std::vector<pool_type>::iterator;
+        using p_iterator = typename pool_type::iterator;
 
-        friend struct drtx::DtIterator<T, obj_count>;
+        friend struct drtx::DtIterator<T, obj_count, Pools, Sizing>;
 
         std::vector<pool_type> pools;
 
     public:
         using value_type = T;
 
-        DtPoolAllocator() : pools() {
-            pools.reserve(16);
-            pools.emplace_back();
-        }
+        /// No pool is created until the first allocation.
+        DtPoolAllocator() : pools() { }
 
         ~DtPoolAllocator() = default;
+        DtPoolAllocator(const DtPoolAllocator&) = delete;
+        DtPoolAllocator& operator=(const DtPoolAllocator&) = delete;
+        DtPoolAllocator(DtPoolAllocator&&) = default;
+        DtPoolAllocator& operator=(DtPoolAllocator&&) = default;
 
         /// @return a pointer to a free block of memory.
         void* allocate() {
@@ -43,7 +60,8 @@ namespace drtx {
             if (ptr) return ptr;
 
             // need to create new pool
-            pools.emplace_back();
+            if (pools.empty()) pools.reserve(16);
+            pools.emplace_back(next_capacity());
             swap_with_front(pools.back());
             return pools.front().allocate();
         }
@@ -68,24 +86,102 @@ namespace drtx {
             return nullptr;
         }
 
+        /**
+         * Releases a batch of blocks whose objects have already been
+         * destroyed, compacting each affected pool once.
+         *
+         * @param holes   Addresses of the blocks; sorted in place.
+         * @param on_move Called as on_move(old, new) for every object that
+         *                is moved to fill a hole.
+         */
+        template<typename OnMove>
+        void release(std::vector<void*> &holes, OnMove &&on_move) {
+            std::sort(holes.begin(), holes.end(), std::less<void*>());
+            void **first = holes.data();
+            void **end = first + holes.size();
+
+            while (first != end) {
+                pool_type *p = owner(*first);
+
+                // a block that no pool owns was not allocated here
+                assert(p);
+                if (!p) {
+                    ++first;
+                    continue;
+                }
+
+                void **last = first;
+
+                while (last != end && p->owns(*last)) ++last;
+
+                p->release(first, last, on_move);
+                first = last;
+            }
+        }
+
+        /// Destroys every object and frees every pool.
         void destroyAll() {
             pools.clear();
-            pools.emplace_back();
+        }
+
+        /// Frees every pool without destroying its objects, which must have been relocated.
+        void forgetAll() {
+            for (pool_type &p : pools) p.forgetAll();
+            pools.clear();
+        }
+
+        /// @return the number of pools currently held.
+        size_t pool_count() const {
+            return pools.size();
+        }
+
+        /// @return the number of bytes held by all pools.
+        size_t capacity_bytes() const {
+            size_t bytes = 0;
+            for (const pool_type &p : pools) bytes += p.capacity_bytes();
+            return bytes;
+        }
+
+        /// @return the exact memory used and reserved, pool by pool.
+        AllocatorUsage usage() const {
+            AllocatorUsage u;
+            u.pools = pools.size();
+            u.bookkeeping_bytes = pools.capacity() * sizeof(pool_type);
+            u.fill.reserve(pools.size());
+
+            for (const pool_type &p : pools) {
+                u.objects += p.size();
+                u.used_bytes += p.size() * sizeof(T);
+                u.reserved_bytes += p.capacity_bytes();
+                u.fill.push_back(static_cast<float>(p.size()) / p.capacity());
+            }
+
+            return u;
         }
 
         iterator begin() {
+            if (pools.empty()) return end();
+
             auto it = pools.begin();
             return iterator(this, it, it->begin());
         }
 
         iterator end() {
+            if (pools.empty()) return iterator(this, pools.begin(), p_iterator());
+
             auto it = v_iterator(&pools.back());
             return iterator(this, it, it->end());
         }
 
     private:
+        size_t next_capacity() const {
+            return Sizing::template capacity<T, obj_count>(pools.size());
+        }
+
         /// @return a pointer to a free block of memory, if one exists.
         void* try_to_allocate() {
+            if (pools.empty()) return nullptr;
+
             // try first pool
             void* ptr = pools.front().allocate();
 
@@ -104,6 +200,14 @@ namespace drtx {
             return ptr;
         }
 
+        /// @return the pool holding ptr, or nullptr if there is none.
+        pool_type* owner(void *ptr) {
+            for (pool_type &s : pools) {
+                if (s.owns(ptr)) return &s;
+            }
+            return nullptr;
+        }
+
         void swap_with_front(pool_type &p) {
             auto tmp = std::move(pools.front());
             pools.front() = std::move(p);
@@ -113,11 +217,11 @@ namespace drtx {
 
 namespace drtx {
 
-    template<typename T, typename C>
+    template<typename T, typename C, typename P, typename S>
     struct DtIterator {
 
         using value_type = T;
-        using alloc_type = DtPoolAllocator<T, C>;
+        using alloc_type = DtPoolAllocator<T, C, P, S>;
         using v_iterator = typename alloc_type::v_iterator;
         using p_iterator = typename alloc_type::pool_type::iterator;
 
@@ -126,7 +230,9 @@ namespace drtx {
         p_iterator it;
 
         DtIterator(alloc_type *a, v_iterator v, p_iterator i)
-                : alloc(a), vit(v), it(i) { }
+                : alloc(a), vit(v), it(i) {
+            skip_exhausted();
+        }
 
         ~DtIterator() = default;
 
@@ -155,12 +261,7 @@ namespace drtx {
          */
         DtIterator& operator++() {
             ++it;
-
-            if (it.loc == vit->size() && *vit != alloc->pools.back()) {
-                ++vit;
-                it = vit->begin();
-            }
-
+            skip_exhausted();
             return *this;
         }
 
@@ -179,13 +280,24 @@ namespace drtx {
         }
 
         // comparing iterator will compare the allocator as well
-        bool operator==(const DtIterator<T, C> &other) {
+        bool operator==(const DtIterator<T, C, P, S> &other) {
             return it == other.it;
         }
 
-        bool operator!=(const DtIterator<T, C> &other) {
+        bool operator!=(const DtIterator<T, C, P, S> &other) {
             return !(*this == other);
         }
+
+    private:
+        /// Moves past the end of each pool (including empty ones) but the last.
+        void skip_exhausted() {
+            if (alloc->pools.empty()) return;
+
+            while (it == vit->end() && *vit != alloc->pools.back()) {
+                ++vit;
+                it = vit->begin();
+            }
+        }
     };
 
 } // namespace drtx
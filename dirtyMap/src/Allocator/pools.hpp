@@ -17,66 +17,78 @@ namespace drtx {
     template<typename T, typename C>
     struct PoolIterator;
 
+    template<typename T, typename C>
+    struct StablePoolIterator;
+
     template<typename T>
     struct buddy_mb_count {
         enum { value = (MPAGE_SIZE * MBUDDY_ORDER) / sizeof(T) };
     };
 
-    template<size_t N>
-    struct alignas(64) pool_storage {
-        unsigned char chunk[N];
-
-        pool_storage() = default;
-        ~pool_storage() = default;
-    };
+    /// @return cache line aligned memory for the blocks of a pool.
+    inline unsigned char* pool_storage(size_t bytes) {
+        void *p = nullptr;
+        if (posix_memalign(&p, 64, bytes ? bytes : 1) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<unsigned char*>(p);
+    }
 
     template <typename T, typename obj_count>
     class _stackPoolBase {
 
         using uchar  = unsigned char;
-        using pool_t = pool_storage<obj_count::value * sizeof(T)>;
 
         friend class PoolIterator<T, obj_count>;
 
         uintptr_t sp;
-        pool_t *storage;
+        uchar *storage;
+        size_t cap;
 
     public:
         using value_type = T;
         using iterator   = PoolIterator<T, obj_count>;
 
-        _stackPoolBase() {
-            storage = new pool_t();
+        /// Objects may be moved by deallocate/destroy.
+        static constexpr bool stable_addresses = false;
+
+        /// @param capacity The number of T objects to reserve space for.
+        explicit _stackPoolBase(size_t capacity = obj_count::value) : cap(capacity) {
+            storage = pool_storage(cap * sizeof(T));
             sp = reinterpret_cast<uintptr_t>(storage);
         }
 
-        ~_stackPoolBase() { delete storage; }
+        ~_stackPoolBase() { free(storage); }
 
         // need noexcept so that pools are move-constructed when the pool vector resizes
-        _stackPoolBase(_stackPoolBase&& other) noexcept : sp(other.sp), storage(other.storage) {
+        _stackPoolBase(_stackPoolBase&& other) noexcept
+                : sp(other.sp), storage(other.storage), cap(other.cap) {
             other.sp = 0;
             other.storage = nullptr;
+            other.cap = 0;
         }
 
         _stackPoolBase& operator=(_stackPoolBase&& other) noexcept {
             if (this != &other) {
-                delete storage;
+                free(storage);
                 storage = other.storage;
                 sp = other.sp;
+                cap = other.cap;
                 other.storage = nullptr;
                 other.sp = 0;
+                other.cap = 0;
             }
 
             return *this;
         }
 
         /// @return the maximum number of objects that can be stored.
-        constexpr size_t capacity() const {
-            return obj_count::value;
+        size_t capacity() const {
+            return cap;
         }
 
         /// @return the number of bytes held by the pool.
-        constexpr size_t capacity_bytes() const {
+        size_t capacity_bytes() const {
             return capacity() * sizeof(T);
         }
 
@@ -114,15 +126,14 @@ namespace drtx {
 
         /**
          * Removes an object from the pool. If this leaves a hole in the stack
-         * then it is filled with the object at the top of the stack.
+         * then the object at the top of the stack is relocated into it.
          */
         void deallocate(void *deallocated) {
             // replace deallocated block with last object in the array
             uintptr_t top = sp - sizeof(T);
 
             if (deallocated < reinterpret_cast<void*>(top)) {
-                T* replacement = reinterpret_cast<T*>(top);
-                new(deallocated) T(std::move(*replacement));
+                relocate(deallocated, reinterpret_cast<T*>(top));
             }
 
             sp = top;
@@ -146,6 +157,36 @@ namespace drtx {
             return reinterpret_cast<void*>(sp);
         }
 
+        /**
+         * Releases several blocks at once, whose objects have already been
+         * destroyed. Holes are filled from the top of the stack in a single
+         * pass; holes that reach the top are simply dropped.
+         *
+         * @param first,last Sorted addresses of blocks owned by this pool.
+         * @param on_move    Called as on_move(old, new) for every moved object.
+         */
+        template<typename OnMove>
+        void release(void **first, void **last, OnMove &&on_move) {
+            while (first != last) {
+                uintptr_t top = sp - sizeof(T);
+
+                if (reinterpret_cast<uintptr_t>(last[-1]) == top) {
+                    --last;
+                } else {
+                    relocate(*first, reinterpret_cast<T*>(top));
+                    on_move(reinterpret_cast<void*>(top), *first);
+                    ++first;
+                }
+
+                sp = top;
+            }
+        }
+
+        /// Empties the pool without destroying anything; its objects must have been relocated.
+        void forgetAll() {
+            sp = reinterpret_cast<uintptr_t>(storage);
+        }
+
         /// @return iterator pointing to index 0 of array.
         iterator begin() {
             return iterator(reinterpret_cast<T*>(storage), 0);
@@ -165,7 +206,7 @@ namespace drtx {
             sp = p;
         }
 
-        pool_t* get_storage() const {
+        uchar* get_storage() const {
             return storage;
         }
 
@@ -191,8 +232,9 @@ namespace drtx {
 } // namespace drtx
 
     /**
-     * Memory pool with a fixed capacity. The size parameter is the number of
-     * objects that you want to store.
+     * Memory pool with a fixed capacity. The size parameter is the default
+     * number of objects that you want to store; the constructor can override
+     * it.
      *
      * We refer to this as a "stack" pool because we enforce contiguous objects
      * and maintain a stack pointer which points to the next free block. When
@@ -216,6 +258,7 @@ namespace drtx {
         using value_type = typename base_type::value_type;
 
         StackedPool() = default;
+        explicit StackedPool(size_t capacity) : base_type(capacity) { }
         ~StackedPool() = default;
         StackedPool(const StackedPool&) = default;
         StackedPool& operator=(const StackedPool&) = default;
@@ -237,6 +280,7 @@ namespace drtx {
         using value_type = typename base_type::value_type;
 
         StackedPool() = default;
+        explicit StackedPool(size_t capacity) : base_type(capacity) { }
         ~StackedPool() { destroyAll(); }
         StackedPool(const StackedPool&) = default;
         StackedPool& operator=(const StackedPool&) = default;
@@ -254,6 +298,255 @@ namespace drtx {
         }
     };
 
+    /**
+     * Memory pool with a fixed capacity whose objects never move. A bitmap
+     * records which blocks are in use: allocation takes the lowest free
+     * block, and deallocation simply clears its bit, leaving a hole to be
+     * reused later. Costs one bit per block, and a pool only becomes
+     * reusable once it is completely full of holes it can hand back out.
+     *
+     * @tparam T The type of object to store.
+     * @tparam obj_count The number of T objects to reserve space for.
+     */
+    template<typename T, typename obj_count = drtx::buddy_mb_count<T>>
+    class StablePool {
+
+        friend struct drtx::StablePoolIterator<T, obj_count>;
+
+        // blocks, followed by the bitmap, in a single allocation
+        unsigned char *chunk;
+        uint64_t *live;
+        size_t cap;
+        size_t count;
+        size_t hint;   // lowest bitmap word that may have a free bit
+        size_t top;    // one past the highest block ever allocated
+
+    public:
+        using value_type = T;
+        using iterator   = drtx::StablePoolIterator<T, obj_count>;
+
+        /// Objects stay put until they are deallocated.
+        static constexpr bool stable_addresses = true;
+
+        /// @param capacity The number of T objects to reserve space for.
+        explicit StablePool(size_t capacity = obj_count::value)
+                : cap(capacity), count(0), hint(0), top(0) {
+            chunk = drtx::pool_storage(bitmap_offset() + words() * sizeof(uint64_t));
+            live = reinterpret_cast<uint64_t*>(chunk + bitmap_offset());
+            std::memset(live, 0, words() * sizeof(uint64_t));
+        }
+
+        ~StablePool() {
+            if (chunk) destroyAll();
+            free(chunk);
+        }
+
+        StablePool(StablePool &&other) noexcept
+                : chunk(other.chunk), live(other.live), cap(other.cap),
+                  count(other.count), hint(other.hint), top(other.top) {
+            other.chunk = nullptr;
+            other.live = nullptr;
+            other.cap = other.count = other.hint = other.top = 0;
+        }
+
+        StablePool& operator=(StablePool &&other) noexcept {
+            if (this != &other) {
+                if (chunk) destroyAll();
+                free(chunk);
+                chunk = other.chunk;
+                live = other.live;
+                cap = other.cap;
+                count = other.count;
+                hint = other.hint;
+                top = other.top;
+                other.chunk = nullptr;
+                other.live = nullptr;
+                other.cap = other.count = other.hint = other.top = 0;
+            }
+
+            return *this;
+        }
+
+        /// @return the maximum number of objects that can be stored.
+        size_t capacity() const {
+            return cap;
+        }
+
+        /// @return the number of bytes held by the pool, including the bitmap.
+        size_t capacity_bytes() const {
+            return bitmap_offset() + words() * sizeof(uint64_t);
+        }
+
+        /// @return the number of objects stored in the pool.
+        size_t size() const {
+            return count;
+        }
+
+        /// @return true if ptr points into the pool's blocks.
+        bool owns(const void *ptr) const {
+            return ptr >= chunk && ptr < chunk + top * sizeof(T);
+        }
+
+        bool full() const {
+            return count == capacity();
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        /// @return a free block, or nullptr if the pool is full.
+        void* allocate() {
+            if (full()) return nullptr;
+
+            while (!~live[hint]) ++hint;
+
+            size_t i = hint * 64 + __builtin_ctzll(~live[hint]);
+            live[hint] |= (uint64_t(1) << (i & 63));
+            ++count;
+            if (i >= top) top = i + 1;
+
+            return chunk + i * sizeof(T);
+        }
+
+        /// Releases a block without calling a destructor. Nothing is moved.
+        void deallocate(void *ptr) {
+            size_t i = index_of(ptr);
+            live[i / 64] &= ~(uint64_t(1) << (i & 63));
+            --count;
+            if (i / 64 < hint) hint = i / 64;
+        }
+
+        /**
+         * Destroys and deallocates the object at ptr.
+         *
+         * @return nullptr: no other object is ever moved.
+         */
+        void* destroy(void *ptr) {
+            reinterpret_cast<T*>(ptr)->~T();
+            deallocate(ptr);
+            return nullptr;
+        }
+
+        /// Releases several destroyed blocks; nothing is moved.
+        template<typename OnMove>
+        void release(void **first, void **last, OnMove &&) {
+            for (; first != last; ++first) {
+                deallocate(*first);
+            }
+        }
+
+        void destroyAll() {
+            if (!std::is_trivially_destructible<T>::value) {
+                for (iterator it = begin(); it != end(); ++it) {
+                    (*it).~T();
+                }
+            }
+
+            forgetAll();
+        }
+
+        /// Empties the pool without destroying anything; its objects must have been relocated.
+        void forgetAll() {
+            std::memset(live, 0, words() * sizeof(uint64_t));
+            count = hint = top = 0;
+        }
+
+        /// @return true if block i holds an object.
+        bool in_use(size_t i) const {
+            return (live[i / 64] >> (i & 63)) & 1;
+        }
+
+        /// @return iterator pointing to the first object in use.
+        iterator begin() {
+            return iterator(this, 0);
+        }
+
+        /// @return iterator pointing one past the highest block ever used.
+        iterator end() {
+            return iterator(this, top);
+        }
+
+        iterator find(void *ptr) {
+            return iterator(this, index_of(ptr));
+        }
+
+        bool operator==(StablePool &other) {
+            return chunk == other.chunk;
+        }
+
+        bool operator!=(StablePool &other) {
+            return !(*this == other);
+        }
+
+    private:
+        size_t index_of(const void *ptr) const {
+            return (static_cast<const unsigned char*>(ptr) - chunk) / sizeof(T);
+        }
+
+        size_t words() const {
+            return (cap + 63) / 64;
+        }
+
+        size_t bitmap_offset() const {
+            return (cap * sizeof(T) + 7) & ~size_t(7);
+        }
+    };
+
+    /// Pool policy: compacting StackedPools (the default).
+    struct stacked_pools {
+        template<typename T, typename obj_count>
+        using pool = StackedPool<T, obj_count>;
+    };
+
+    /// Pool policy: StablePools, whose objects never move.
+    struct stable_pools {
+        template<typename T, typename obj_count>
+        using pool = StablePool<T, obj_count>;
+    };
+
+    /*
+     * Pool sizing policies. DtPoolAllocator asks for the capacity of each
+     * pool it creates, passing the number of pools it already has.
+     */
+
+    /// Every pool holds obj_count objects (MBUDDY_ORDER pages by default).
+    struct fixed_pool_size {
+        template<typename T, typename obj_count>
+        static size_t capacity(size_t) {
+            return obj_count::value;
+        }
+    };
+
+    /// Every pool is `Bytes` long, e.g. 2 MB or 32 MB for very large maps.
+    template<size_t Bytes>
+    struct pool_bytes {
+        template<typename T, typename>
+        static size_t capacity(size_t) {
+            return Bytes / sizeof(T) ? Bytes / sizeof(T) : 1;
+        }
+    };
+
+    /**
+     * The first pool is `First` bytes and each new pool is twice the size of
+     * the last, up to `Max` bytes. Small maps stay small, while large maps
+     * still end up with few pools to scan.
+     */
+    template<size_t First = MPAGE_SIZE, size_t Max = MPAGE_SIZE * MBUDDY_ORDER>
+    struct geometric_pool_size {
+        static_assert(First > 0 && First <= Max, "geometric_pool_size needs 0 < First <= Max");
+
+        template<typename T, typename>
+        static size_t capacity(size_t existing) {
+            size_t bytes = Max;
+
+            if (existing < 8 * sizeof(size_t) && (Max >> existing) >= First) {
+                bytes = First << existing;
+            }
+            return bytes / sizeof(T) ? bytes / sizeof(T) : 1;
+        }
+    };
+
 namespace drtx {
 
     /**
@@ -312,6 +605,60 @@ namespace drtx {
         }
     };
 
+    /**
+     * Iterator class for StablePool. Moves over blocks that are not in use.
+     * As with PoolIterator, operator-- exists only so that a block can be
+     * revisited after it has been deallocated.
+     */
+    template<typename T, typename C>
+    struct StablePoolIterator {
+
+        using pool_type = StablePool<T, C>;
+
+        pool_type *pool;
+        size_t loc;
+
+        StablePoolIterator() : pool(nullptr), loc(0) {}
+
+        StablePoolIterator(pool_type *p, size_t i) : pool(p), loc(i) {
+            skip();
+        }
+
+        T& operator*() {
+            return reinterpret_cast<T*>(pool->chunk)[loc];
+        }
+
+        StablePoolIterator& operator++() {
+            ++loc;
+            skip();
+            return *this;
+        }
+
+        StablePoolIterator operator++(int) {
+            StablePoolIterator temp(*this);
+            ++(*this);
+            return temp;
+        }
+
+        StablePoolIterator& operator--() {
+            --loc;
+            return *this;
+        }
+
+        bool operator==(const StablePoolIterator<T, C> &other) {
+            return pool == other.pool && loc == other.loc;
+        }
+
+        bool operator!=(const StablePoolIterator<T, C> &other) {
+            return !(*this == other);
+        }
+
+    private:
+        void skip() {
+            while (loc < pool->top && !pool->in_use(loc)) ++loc;
+        }
+    };
+
 } // namespace drtx
 } // namespace drt
 
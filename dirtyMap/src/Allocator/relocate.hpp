@@ -0,0 +1,84 @@
+#ifndef FYP_MAPS_RELOCATE_HPP
+#define FYP_MAPS_RELOCATE_HPP
+
+namespace drt {
+namespace drtx {
+
+    /**
+     * True if a T can be moved to another address by copying its bytes,
+     * after which the source is simply forgotten. std::pair's assignment
+     * keeps a pair of trivially copyable parts from being trivially
+     * copyable itself, so pairs are judged by their parts.
+     */
+    template<typename T>
+    struct trivially_relocatable : std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value> { };
+
+    template<typename T>
+    struct trivially_relocatable<const T> : trivially_relocatable<T> { };
+
+    template<typename K, typename M>
+    struct trivially_relocatable<std::pair<K, M>> : std::integral_constant<bool,
+            trivially_relocatable<K>::value && trivially_relocatable<M>::value> { };
+
+    template<typename T>
+    inline void relocate(void *to, T *from, std::true_type) noexcept {
+        std::memcpy(to, static_cast<const void*>(from), sizeof(T));
+    }
+
+    template<typename T>
+    inline void relocate(void *to, T *from, std::false_type) {
+        new(to) T(std::move(*from));
+        from->~T();
+    }
+
+    /**
+     * Moves the object at `from` into the raw block at `to` and ends the
+     * life of the original: a memcpy for trivially relocatable types, or a
+     * move construction and destruction for the others.
+     */
+    template<typename T>
+    inline void relocate(void *to, T *from) {
+        relocate(to, from, trivially_relocatable<T>());
+    }
+
+    template<typename T>
+    inline void move_construct(void *to, T *from, std::true_type) noexcept {
+        std::memcpy(to, static_cast<const void*>(from), sizeof(T));
+    }
+
+    template<typename T>
+    inline void move_construct(void *to, T *from, std::false_type) {
+        new(to) T(std::move(*from));
+    }
+
+    /**
+     * As relocate(), but the original is left for its owner to destroy
+     * (trivially, when it was copied with memcpy).
+     */
+    template<typename T>
+    inline void move_construct(void *to, T *from) {
+        move_construct(to, from, trivially_relocatable<T>());
+    }
+
+    /// As relocate(), for n objects from a contiguous array.
+    template<typename T>
+    inline void relocate_n(void *to, T *from, size_t n, std::true_type) noexcept {
+        if (n) std::memcpy(to, static_cast<const void*>(from), n * sizeof(T));
+    }
+
+    template<typename T>
+    inline void relocate_n(void *to, T *from, size_t n, std::false_type) {
+        T *dest = static_cast<T*>(to);
+        for (size_t i = 0; i < n; ++i) relocate(dest + i, from + i, std::false_type());
+    }
+
+    template<typename T>
+    inline void relocate_n(void *to, T *from, size_t n) {
+        relocate_n(to, from, n, trivially_relocatable<T>());
+    }
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_RELOCATE_HPP
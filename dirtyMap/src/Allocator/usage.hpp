@@ -0,0 +1,33 @@
+#ifndef FYP_MAPS_USAGE_HPP
+#define FYP_MAPS_USAGE_HPP
+
+#include <vector>
+
+namespace drt {
+
+    /**
+     * Exact memory held by a DtPoolAllocator, computed from its pools rather
+     * than estimated from the process.
+     */
+    struct AllocatorUsage {
+        size_t pools             = 0;
+        size_t objects           = 0;
+        size_t used_bytes        = 0;   ///< occupied by live objects
+        size_t reserved_bytes    = 0;   ///< held by all pools, bitmaps included
+        size_t bookkeeping_bytes = 0;   ///< the allocator's own vector of pools
+        std::vector<float> fill;        ///< objects / capacity of each pool
+
+        /// @return the share of reserved pool memory that holds objects.
+        float fill_ratio() const {
+            return reserved_bytes ? static_cast<float>(used_bytes) / reserved_bytes : 0;
+        }
+
+        /// @return every byte the allocator has allocated.
+        size_t total_bytes() const {
+            return reserved_bytes + bookkeeping_bytes;
+        }
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_USAGE_HPP
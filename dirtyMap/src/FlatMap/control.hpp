@@ -0,0 +1,127 @@
+
+#ifndef FYP_MAPS_CONTROL_HPP
+#define FYP_MAPS_CONTROL_HPP
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace drt {
+namespace drtx {
+
+    /*
+     * Control bytes. A full slot stores the low 7 bits of its element's hash
+     * (so the top bit is clear); empty and deleted slots have the top bit set
+     * and can be told apart from each other and from full slots with a
+     * single signed comparison.
+     */
+    enum : int8_t {
+        ctrl_empty   = -128,   // 0b10000000
+        ctrl_deleted = -2      // 0b11111110
+    };
+
+    /// @return true if the control byte marks a slot holding an element.
+    inline bool is_full(int8_t c) noexcept {
+        return c >= 0;
+    }
+
+    /**
+     * Bit mask over the slots of a group. Iterating yields the index of each
+     * set bit, lowest first.
+     */
+    struct GroupMask {
+        uint32_t mask;
+
+        explicit GroupMask(uint32_t m) : mask(m) { }
+
+        explicit operator bool() const noexcept {
+            return mask != 0;
+        }
+
+        /// @return index of the lowest set bit. Mask must not be empty.
+        unsigned int lowest() const noexcept {
+            return static_cast<unsigned int>(__builtin_ctz(mask));
+        }
+
+        /// Clears the lowest set bit.
+        GroupMask& operator++() noexcept {
+            mask &= mask - 1;
+            return *this;
+        }
+    };
+
+    /**
+     * A view over 16 consecutive control bytes. With SSE2 every query is a
+     * single compare and movemask; otherwise we fall back to a byte loop.
+     */
+    struct ControlGroup {
+
+        enum { width = 16 };
+
+#ifdef __SSE2__
+        __m128i ctrl;
+
+        /// pos must be 16-byte aligned.
+        explicit ControlGroup(const int8_t *pos)
+                : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(pos))) { }
+
+        /// @return slots whose control byte equals h2.
+        GroupMask match(int8_t h2) const noexcept {
+            __m128i m = _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl);
+            return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(m)));
+        }
+
+        /// @return slots which have never held an element since the last rehash.
+        GroupMask match_empty() const noexcept {
+            return match(ctrl_empty);
+        }
+
+        /// @return slots that can accept a new element.
+        GroupMask match_empty_or_deleted() const noexcept {
+            __m128i m = _mm_cmplt_epi8(ctrl, _mm_set1_epi8(-1));
+            return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(m)));
+        }
+
+        /// @return slots holding an element.
+        GroupMask match_full() const noexcept {
+            return GroupMask(static_cast<uint32_t>(~_mm_movemask_epi8(ctrl)) & 0xFFFF);
+        }
+#else
+        const int8_t *ctrl;
+
+        explicit ControlGroup(const int8_t *pos) : ctrl(pos) { }
+
+        GroupMask match(int8_t h2) const noexcept {
+            uint32_t m = 0;
+            for (unsigned int i = 0; i < width; ++i) {
+                if (ctrl[i] == h2) m |= (1u << i);
+            }
+            return GroupMask(m);
+        }
+
+        GroupMask match_empty() const noexcept {
+            return match(ctrl_empty);
+        }
+
+        GroupMask match_empty_or_deleted() const noexcept {
+            uint32_t m = 0;
+            for (unsigned int i = 0; i < width; ++i) {
+                if (ctrl[i] < -1) m |= (1u << i);
+            }
+            return GroupMask(m);
+        }
+
+        GroupMask match_full() const noexcept {
+            uint32_t m = 0;
+            for (unsigned int i = 0; i < width; ++i) {
+                if (is_full(ctrl[i])) m |= (1u << i);
+            }
+            return GroupMask(m);
+        }
+#endif
+    };
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_CONTROL_HPP
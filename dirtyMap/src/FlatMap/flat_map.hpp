@@ -0,0 +1,434 @@
+
+#ifndef FYP_MAPS_FLAT_MAP_HPP
+#define FYP_MAPS_FLAT_MAP_HPP
+
+#include <tuple>      // tuple, forward_as_tuple
+#include <cstring>    // memset
+#include <stdexcept>  // out_of_range
+#include <new>        // placement new
+
+namespace drt {
+
+    /**
+     * Open-addressing alternative to Hashmap, laid out in the style of a
+     * "Swiss table". Elements are stored directly in an array of slots, and
+     * a parallel array holds one control byte per slot: either a 7 bit
+     * fingerprint of the element's hash, or a marker for an empty/deleted
+     * slot. Lookups scan 16 control bytes at a time (with SSE2 where it is
+     * available) and only touch a slot when its fingerprint matches, so most
+     * lookups cost a single cache miss in the control array plus one in the
+     * slot array.
+     *
+     * The public interface mirrors Hashmap so the two can be swapped in
+     * benchmarks. The main differences are that bucket_count() reports the
+     * number of slots, and that the maximum load factor is capped at 15/16
+     * since probing relies on every table containing an empty slot.
+     *
+     * @tparam Key  Type of key objects.
+     * @tparam Val  Type of mapped objects.
+     * @tparam Hash Type of hash function used for value lookups.
+     */
+    template<class Key, class Val, class Hash = std::hash<Key>>
+    class FlatDirtyMap {
+
+    public:
+        using key_type        =  Key;
+        using mapped_type     =  Val;
+        using value_type      =  std::pair<const Key, Val>;
+        using iterator        =  drtx::FlatMapIterator<value_type>;
+
+    private:
+        using group_type      =  drtx::ControlGroup;
+
+        enum { group_width = group_type::width };
+
+        static_assert(alignof(value_type) <= group_width,
+                      "FlatDirtyMap slots are only 16-byte aligned");
+
+        int8_t *ctrl = nullptr;
+        value_type *slots = nullptr;
+        Hash hasher;
+
+        size_t _capacity = 0;
+        size_t _element_count = 0;
+        size_t _deleted_count = 0;
+        float _max_load_factor = 0.875;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    public:
+        // constructors & destructor
+
+        FlatDirtyMap() : hasher() { }
+
+        FlatDirtyMap(size_t n, const Hash &hf = Hash()) : hasher(hf) {
+            rehash(n);
+        }
+
+        ~FlatDirtyMap() {
+            destroy_table();
+        }
+
+        FlatDirtyMap(const FlatDirtyMap&) = delete;
+        FlatDirtyMap& operator=(const FlatDirtyMap&) = delete;
+
+        FlatDirtyMap(FlatDirtyMap &&other) noexcept
+                : ctrl(other.ctrl), slots(other.slots), hasher(std::move(other.hasher)),
+                  _capacity(other._capacity), _element_count(other._element_count),
+                  _deleted_count(other._deleted_count), _max_load_factor(other._max_load_factor) {
+            other.release();
+        }
+
+        FlatDirtyMap& operator=(FlatDirtyMap &&other) noexcept {
+            if (this != &other) {
+                destroy_table();
+                ctrl = other.ctrl;
+                slots = other.slots;
+                hasher = std::move(other.hasher);
+                _capacity = other._capacity;
+                _element_count = other._element_count;
+                _deleted_count = other._deleted_count;
+                _max_load_factor = other._max_load_factor;
+                other.release();
+            }
+
+            return *this;
+        }
+
+        // size & capacity
+
+        /// Returns the number of elements in the map.
+        size_t size() const noexcept {
+            return _element_count;
+        }
+
+        /// Returns maximum number of elements that can be stored.
+        size_t max_size() const noexcept {
+            return npos / (sizeof(value_type) + 1);
+        }
+
+        /// Returns the number of slots in the map.
+        size_t bucket_count() const noexcept {
+            return _capacity;
+        }
+
+        /// Returns true if there are no elements in the map.
+        bool empty() const noexcept {
+            return _element_count == 0;
+        }
+
+        // modifiers
+
+        /**
+         * Removes all elements from the map. Does not change the number
+         * of slots.
+         */
+        void clear() {
+            destroy_elements();
+
+            if (_capacity) {
+                std::memset(ctrl, drtx::ctrl_empty, _capacity);
+            }
+
+            _element_count = 0;
+            _deleted_count = 0;
+        }
+
+        /**
+         * Removes and destroys the element corresponding to key k.
+         *
+         * @param k Key of the element to be removed.
+         * @return  The number of elements that were removed (0 or 1).
+         */
+        size_t erase(const Key &k) {
+            size_t i = find_index(k, hash_of(k));
+            if (i == npos) return 0;
+
+            slots[i].~value_type();
+
+            // A slot may only go back to empty if no probe sequence can have
+            // passed over its group, which is the case while the group still
+            // has an empty slot (it has never been full since the last rehash).
+            if (group_type(ctrl + (i & ~size_t(group_width - 1))).match_empty()) {
+                ctrl[i] = drtx::ctrl_empty;
+            } else {
+                ctrl[i] = drtx::ctrl_deleted;
+                ++_deleted_count;
+            }
+
+            _element_count -= 1;
+            return 1;
+        }
+
+        // lookup
+
+        /**
+         * @brief @c [] access to map elements.
+         * @param k The key for which a mapped value should be returned.
+         * @return A reference to the value associated with k.
+         */
+        mapped_type& operator[](const Key &k) {
+            size_t h = hash_of(k);
+            size_t i = find_index(k, h);
+
+            if (i == npos) {
+                i = prepare_insert(h);
+                new(slots + i) value_type(std::piecewise_construct,
+                        std::tuple<const Key&>(k),
+                        std::tuple<>());
+            }
+
+            return slots[i].second;
+        }
+
+        /**
+         * @brief @c [] access to map elements.
+         * @param k The key for which a mapped value should be returned.
+         * @return A reference to the value associated with k.
+         */
+        mapped_type& operator[](Key &&k) {
+            size_t h = hash_of(k);
+            size_t i = find_index(k, h);
+
+            if (i == npos) {
+                i = prepare_insert(h);
+                new(slots + i) value_type(std::piecewise_construct,
+                        std::forward_as_tuple(std::move(k)),
+                        std::tuple<>());
+            }
+
+            return slots[i].second;
+        }
+
+        /**
+         * @brief Access to map elements.
+         * @param k The key for which a mapped value should be returned.
+         * @return A reference to the value associated with k, if it exists.
+         *
+         * Return the value mapped to the provided key. If it doesn't exist in
+         * the map, throw an out_of_range error.
+         */
+        mapped_type& at(const Key &k) {
+            size_t i = find_index(k, hash_of(k));
+
+            if (i == npos) {
+                throw std::out_of_range("FlatDirtyMap::at");
+            }
+
+            return slots[i].second;
+        }
+
+        /**
+         * @param k The key for which to count elements.
+         * @return The number of elements with the provided key (1 or 0).
+         */
+        size_t count(const Key &k) const {
+            return find_index(k, hash_of(k)) == npos ? 0 : 1;
+        }
+
+        // rehashing
+
+        /// Returns maximum ratio of elements to slots.
+        float max_load_factor() const noexcept {
+            return _max_load_factor;
+        }
+
+        /// Setter for the maximum load factor, which is capped at 15/16.
+        void max_load_factor(float f) {
+            _max_load_factor = std::min(f, 0.9375f);
+        }
+
+        /// Returns the current ratio of elements to slots.
+        float load_factor() const noexcept {
+            if (!_capacity) return 0.0;
+            return static_cast<float>(size()) / static_cast<float>(bucket_count());
+        }
+
+        /**
+         * Grows the table to at least new_size slots (rounded up to a power
+         * of two) and reinserts all elements.
+         *
+         * @param new_size The new number of slots to use.
+         */
+        void rehash(size_t new_size) {
+            if (new_size <= bucket_count()) return;
+            resize(round_capacity(new_size));
+        }
+
+        // iterators
+
+        iterator begin() {
+            return iterator(ctrl, slots, ctrl + _capacity);
+        }
+
+        iterator end() {
+            return iterator(ctrl + _capacity, slots + _capacity, ctrl + _capacity);
+        }
+
+    private:
+        /**
+         * std::hash is the identity for integers, which would leave the
+         * fingerprint and the group index correlated. Mix the bits first
+         * (the finaliser from MurmurHash3).
+         */
+        size_t hash_of(const Key &k) const {
+            uint64_t h = hasher(k);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+
+        /// Fingerprint stored in the control byte of a full slot.
+        static int8_t h2(size_t h) noexcept {
+            return static_cast<int8_t>(h & 0x7F);
+        }
+
+        /// @return the number of elements (including tombstones) allowed in a table of cap slots.
+        size_t max_fill(size_t cap) const noexcept {
+            size_t f = static_cast<size_t>(cap * _max_load_factor);
+            return f < cap || !cap ? f : cap - 1;
+        }
+
+        /// @return the smallest power of two, no less than one group, that is at least n.
+        static size_t round_capacity(size_t n) noexcept {
+            size_t cap = group_width;
+            while (cap < n) cap <<= 1;
+            return cap;
+        }
+
+        /**
+         * Walks the probe sequence for h, one group at a time. Groups are
+         * visited with triangular steps, which covers every group when the
+         * group count is a power of two.
+         *
+         * @return slot index of the element with key k, or npos.
+         */
+        size_t find_index(const Key &k, size_t h) const {
+            if (!_capacity) return npos;
+
+            const size_t mask = (_capacity / group_width) - 1;
+            const int8_t fp = h2(h);
+            size_t g = (h >> 7) & mask;
+
+            for (size_t step = 1; ; ++step) {
+                group_type group(ctrl + g * group_width);
+
+                for (drtx::GroupMask m = group.match(fp); m; ++m) {
+                    size_t i = g * group_width + m.lowest();
+
+                    if (slots[i].first == k) {
+                        return i;
+                    }
+                }
+
+                if (group.match_empty()) return npos;
+                g = (g + step) & mask;
+            }
+        }
+
+        /// @return index of the first slot in h's probe sequence that is not full.
+        size_t find_free(size_t h) const {
+            const size_t mask = (_capacity / group_width) - 1;
+            size_t g = (h >> 7) & mask;
+
+            for (size_t step = 1; ; ++step) {
+                drtx::GroupMask m = group_type(ctrl + g * group_width).match_empty_or_deleted();
+
+                if (m) return g * group_width + m.lowest();
+                g = (g + step) & mask;
+            }
+        }
+
+        /**
+         * Claims a slot for a new element with hash h, growing the table first
+         * if needed. The slot's control byte is set, but the element itself
+         * must be constructed by the caller.
+         */
+        size_t prepare_insert(size_t h) {
+            if (_element_count + _deleted_count + 1 > max_fill(_capacity)) {
+                grow();
+            }
+
+            size_t i = find_free(h);
+            if (ctrl[i] == drtx::ctrl_deleted) --_deleted_count;
+            ctrl[i] = h2(h);
+            ++_element_count;
+            return i;
+        }
+
+        /**
+         * Picks a new table size. If most of the fill is tombstones then a
+         * rehash at the same capacity is enough to reclaim them.
+         */
+        void grow() {
+            size_t cap = _capacity;
+
+            if (!cap || _deleted_count <= _element_count / 2) {
+                cap = cap ? cap * 2 : size_t(group_width);
+            }
+
+            while (max_fill(cap) < _element_count + 1) {
+                cap <<= 1;
+            }
+
+            resize(cap);
+        }
+
+        /// Moves every element into a freshly allocated table of new_cap slots.
+        void resize(size_t new_cap) {
+            int8_t *old_ctrl = ctrl;
+            value_type *old_slots = slots;
+            size_t old_cap = _capacity;
+
+            allocate_table(new_cap);
+
+            for (size_t i = 0; i < old_cap; ++i) {
+                if (!drtx::is_full(old_ctrl[i])) continue;
+
+                value_type &element = old_slots[i];
+                size_t h = hash_of(element.first);
+                size_t j = find_free(h);
+                ctrl[j] = h2(h);
+                new(slots + j) value_type(std::move(element));
+                element.~value_type();
+            }
+
+            _deleted_count = 0;
+            ::operator delete(old_ctrl);
+        }
+
+        /// Control bytes and slots share one allocation, control bytes first.
+        void allocate_table(size_t cap) {
+            void *mem = ::operator new(cap + cap * sizeof(value_type));
+            ctrl = static_cast<int8_t*>(mem);
+            slots = reinterpret_cast<value_type*>(ctrl + cap);
+            _capacity = cap;
+            std::memset(ctrl, drtx::ctrl_empty, cap);
+        }
+
+        void destroy_elements() {
+            for (size_t i = 0; i < _capacity; ++i) {
+                if (drtx::is_full(ctrl[i])) slots[i].~value_type();
+            }
+        }
+
+        void destroy_table() {
+            destroy_elements();
+            ::operator delete(ctrl);
+            release();
+        }
+
+        /// Forgets the table without freeing it (used after a move).
+        void release() noexcept {
+            ctrl = nullptr;
+            slots = nullptr;
+            _capacity = 0;
+            _element_count = 0;
+            _deleted_count = 0;
+        }
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_FLAT_MAP_HPP
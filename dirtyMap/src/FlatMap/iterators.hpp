@@ -0,0 +1,70 @@
+
+#ifndef FYP_MAPS_FLAT_ITERATORS_HPP
+#define FYP_MAPS_FLAT_ITERATORS_HPP
+
+namespace drt {
+namespace drtx {
+
+    /**
+     * Iterator class that traverses the slots of a FlatDirtyMap, skipping
+     * over any slot whose control byte is not full.
+     */
+    template<typename Val>
+    class FlatMapIterator {
+    private:
+        using value_type = Val;
+
+        const int8_t *ctrl;
+        value_type *slot;
+        const int8_t *end;
+
+    public:
+        FlatMapIterator(const int8_t *c, value_type *s, const int8_t *e)
+                : ctrl(c), slot(s), end(e) {
+            skipEmpty();
+        }
+
+        value_type& operator*() {
+            return *slot;
+        }
+
+        value_type* operator->() {
+            return slot;
+        }
+
+        /// Moves to the next full slot.
+        FlatMapIterator& operator++() {
+            ++ctrl;
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+
+        /// Moves to the next full slot.
+        FlatMapIterator operator++(int) {
+            FlatMapIterator temp(*this);
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const FlatMapIterator &other) const {
+            return ctrl == other.ctrl;
+        }
+
+        bool operator!=(const FlatMapIterator &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        void skipEmpty() {
+            while (ctrl != end && !is_full(*ctrl)) {
+                ++ctrl;
+                ++slot;
+            }
+        }
+    };
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_FLAT_ITERATORS_HPP
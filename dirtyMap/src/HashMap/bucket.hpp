@@ -5,54 +5,149 @@
 namespace drt {
 namespace drtx {
 
-    template<typename Val>
+    template<typename Val, bool Tagged = false>
     class BucketIterator;
 
+    /// Probe counter that compiles away; used by ordinary lookups.
+    struct null_probes {
+        void operator()() const noexcept { }
+    };
+
+    /// Counts the stored entries a search dereferences.
+    struct probe_counter {
+        size_t n = 0;
+
+        void operator()() noexcept {
+            ++n;
+        }
+    };
+
+    /**
+     * Derives a tag of `bits` bits from a hash. Bucket indexing consumes
+     * the low bits, so multiply first to fold every bit of the hash into
+     * the top of the word, and take the tag from there.
+     */
+    template<unsigned int bits>
+    inline uintptr_t fingerprint(size_t h) noexcept {
+        return static_cast<uintptr_t>((h * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+    }
+
     template<typename T>
     struct _bNode {
         /* Main holder of data in bucket list. Every node except the
                final one in the list will be a BNode. */
 
-        // DO NOT REORDER THESE!
-        T element;
+        // DO NOT REORDER THESE! The link comes first so that a chain step
+        // reads it from the same cache line as the key, however large the
+        // mapped value. Bucket and BucketGroup chains point at elements,
+        // never at the node itself; InlineBucket's chain links nodes.
         void *next = nullptr;
+        T element;
 
         _bNode() = default;
         _bNode(T &&e) noexcept : element(std::move(e)) {}
         ~_bNode() = default;
+
+        /// Bytes from the start of a node to its element.
+        static constexpr size_t element_offset() {
+            return (sizeof(void*) + alignof(T) - 1) / alignof(T) * alignof(T);
+        }
+
+        /// @return the node holding the element at `element`.
+        static _bNode* of(void *element) noexcept {
+            return reinterpret_cast<_bNode*>(static_cast<char*>(element) - element_offset());
+        }
+
+        static _bNode* of(uintptr_t element) noexcept {
+            return reinterpret_cast<_bNode*>(element - element_offset());
+        }
+
+        /// @return the element of the node block at `node` (which may be unconstructed).
+        static void* element_of(void *node) noexcept {
+            return static_cast<char*>(node) + element_offset();
+        }
+    };
+
+    /**
+     * Bits of a bucket pointer. The low two bits are always dirty bits. With
+     * tagging enabled, the top 16 bits (unused by x86-64 user space
+     * addresses) carry a fingerprint of the entry pointed to.
+     */
+    template<bool Tagged>
+    struct ptr_bits {
+        static constexpr uintptr_t flags = 3;
+        static constexpr uintptr_t tag   = Tagged ? 0xFFFF000000000000ULL : 0;
+        static constexpr uintptr_t addr  = ~(flags | tag);
+
+        static_assert(!Tagged || sizeof(void*) == 8,
+                      "pointer tagging requires 64 bit pointers");
+
+        /// @return the tag for a hash, already shifted into place.
+        static uintptr_t tag_of(size_t h) noexcept {
+            return Tagged ? fingerprint<16>(h) << 48 : 0;
+        }
     };
 
     /**
      * Container for nodes in the Hashmap.
      *
-     * @tparam Key Type of key object.
-     * @tparam Val Type of mapped objects.
+     * @tparam Key    Type of key object.
+     * @tparam Val    Type of mapped objects.
+     * @tparam Tagged If true, each pointer in the list also holds a 16 bit
+     *                fingerprint of the entry it points to, so entries whose
+     *                fingerprint differs are rejected without reading them.
      */
-    template<typename Key, typename Val>
+    template<typename Key, typename Val, bool Tagged = false>
     struct Bucket {
 
         using value_type  =  Val;
         using bNode       =  _bNode<value_type>;
-        using iterator    =  BucketIterator<value_type>;
+        using iterator    =  BucketIterator<value_type, Tagged>;
         // misc return type alias for brevity
         using bool_ptr    =  std::pair<bool, bNode*>;
 
         void *head = nullptr;
 
+        /// Ratio of elements to buckets at which Hashmap grows by default.
+        static constexpr float default_max_load_factor() {
+            return 1.0;
+        }
+
         /**
          * Searches for an element with key = k.
          *
          * @param  k The key to search for.
+         * @param  h Hash of k. Only used when tagging.
          * @return A value_type, if the key is matched; otherwise a nullptr.
          */
-        value_type* search(const Key &k) const {
+        value_type* search(const Key &k, size_t h = 0) const {
+            null_probes probes;
+            return search(k, h, probes);
+        }
+
+        /**
+         * Searches for an element with key = k, reporting every entry read
+         * to `probes`. When tagging, an entry is only compared if its tag
+         * matches, though nodes must still be read to find the next link.
+         */
+        template<typename Counter>
+        value_type* search(const Key &k, size_t h, Counter &probes) const {
+            const uintptr_t tag = bits::tag_of(h);
             iterator it = begin();
 
             while (it.current) {
-                value_type *element = it.current_element();
+                bool match = it.tag() == tag;
 
-                if (element->first == k) {
-                    return element;
+                if (match || !it.at_tail()) {
+                    probes();
+                }
+
+                if (match) {
+                    value_type *element = it.current_element();
+
+                    if (element->first == k) {
+                        return element;
+                    }
                 }
                 ++it;
             }
@@ -65,9 +160,10 @@ namespace drtx {
          * empty buckets.
          *
          * @param element Pointer to an element.
+         * @param h       Hash of the element's key.
          */
-        void insert_node(value_type *element) {
-            head = flag(element, 1);
+        void insert_node(value_type *element, size_t h = 0) {
+            head = tagged(flag(element, 1), h);
         }
 
         /**
@@ -75,23 +171,28 @@ namespace drtx {
          * an empty bucket.
          *
          * @param node Pointer to a node.
+         * @param h    Hash of the node's key.
          */
-        void insert_node(bNode *node) {
+        void insert_node(bNode *node, size_t h = 0) {
             node->next = head;
-            head = flag(node, 3);
+            head = tagged(flag(&node->element, 3), h);
         }
 
         /**
          * Removes a node from the list. Note that this doesn't destroy the
          * object; that is taken care of in Hashmap. The contents of the
          * return type inform Hashmap on what to do next.
+         *
+         * If keep_nodes is set, a node left at the end of the list stays a
+         * node (with a null `next`) rather than being returned for
+         * conversion into an element, so that nothing has to move.
          */
-        bool_ptr remove_node(void *to_remove) {
+        bool_ptr remove_node(void *to_remove, bool keep_nodes = false) {
             if (flag(head) == 1) {
                 head = nullptr;
                 return bool_ptr(true, nullptr);
             } else if (clean(head) == reinterpret_cast<uintptr_t>(to_remove)) {
-                bNode *r = reinterpret_cast<bNode*>(to_remove);
+                bNode *r = bNode::of(to_remove);
                 head = r->next;
                 r->next = nullptr;
                 return bool_ptr(false, nullptr);
@@ -102,9 +203,12 @@ namespace drtx {
             // to_remove might be the element at the end of the list
             if (flag(b->next) == 1) {
                 b->next = nullptr;
+                if (keep_nodes) return bool_ptr(true, nullptr);
 
-                if (clean(head) == reinterpret_cast<uintptr_t>(b)) {
-                    head = reinterpret_cast<void*>(clean(head) ^ 1);
+                if (clean(head) == reinterpret_cast<uintptr_t>(&b->element)) {
+                    // mark the head as an element, keeping its tag
+                    head = reinterpret_cast<void*>(
+                            (reinterpret_cast<uintptr_t>(head) & ~bits::flags) | 1);
                 }
 
                 // b needs to be moved from node -> element
@@ -112,7 +216,7 @@ namespace drtx {
             }
 
             // to_remove is a node
-            bNode *node_to_remove = reinterpret_cast<bNode*>(to_remove);
+            bNode *node_to_remove = bNode::of(to_remove);
             b->next = node_to_remove->next;
             node_to_remove->next = nullptr;
 
@@ -120,26 +224,31 @@ namespace drtx {
         }
 
         /**
-         * Changes an invalid "next" pointer to the correct one.
+         * Changes an invalid "next" pointer to the correct one. `old_addr`
+         * is the element that was linked, whether bare or in a node.
          */
         void update_element(void *old_addr, void *new_addr) {
             if (isSingle()) {
-                head = flag(new_addr, 1);
+                head = rebase(head, new_addr, 1);
             } else {
                 bNode *b = node_before(old_addr);
-                b->next = flag(new_addr, 1);
+                b->next = rebase(b->next, new_addr, 1);
             }
         }
 
         /**
-         * Changes an invalid "head"/"next" pointer to the correct one.
+         * Changes an invalid "head"/"next" pointer to the correct one. The
+         * addresses are of node blocks, as the node pool reports them.
          */
-        void update_node(void *old_addr, void *new_addr) {
+        void update_node(void *old_node, void *new_node) {
+            void *old_addr = bNode::element_of(old_node);
+            void *new_addr = bNode::element_of(new_node);
+
             if (isHead(old_addr)) {
-                head = flag(new_addr, 3);
+                head = rebase(head, new_addr, 3);
             } else {
                 bNode *b = node_before(old_addr);
-                b->next = new_addr;
+                b->next = rebase(b->next, new_addr, flag(b->next));
             }
         }
 
@@ -147,6 +256,19 @@ namespace drtx {
             return iterator(head);
         }
 
+        /// Forgets every node in the bucket without destroying them.
+        void clear() noexcept {
+            head = nullptr;
+        }
+
+        /**
+         * @return true if a new entry should be stored as a bare element
+         * rather than a node. Only the tail of a chain is an element.
+         */
+        bool accepts_element() const noexcept {
+            return isEmpty();
+        }
+
         /// @return true if there are no nodes in this bucket.
         bool isEmpty() const noexcept {
             return head == nullptr;
@@ -163,6 +285,8 @@ namespace drtx {
         }
 
     protected:
+        using bits = ptr_bits<Tagged>;
+
         /// Return true if p points to an element.
         bool isTail(uintptr_t p) const noexcept {
             return ((p & 3) == 1);
@@ -174,7 +298,7 @@ namespace drtx {
         }
 
         bool isHead(uintptr_t p) const noexcept {
-            return (reinterpret_cast<uintptr_t>(head) & ~3) == p;
+            return clean(head) == p;
         }
 
         bool isHead(void *ptr) const noexcept {
@@ -182,9 +306,9 @@ namespace drtx {
         }
 
     private:
-        /// Strips dirty bits from address
+        /// Strips dirty bits (and tag) from address
         uintptr_t clean(void *ptr) const {
-            return reinterpret_cast<uintptr_t>(ptr) & ~3;
+            return reinterpret_cast<uintptr_t>(ptr) & bits::addr;
         }
 
         /// Stores dirty bits in an address
@@ -198,12 +322,25 @@ namespace drtx {
             return reinterpret_cast<uintptr_t>(ptr) & 3;
         }
 
-        /// Finds the bNode whose (cleaned) `next` is `ptr`.
+        /// Adds the tag for hash h to a (flagged) address
+        void* tagged(void *ptr, size_t h) const {
+            return reinterpret_cast<void*>(
+                    reinterpret_cast<uintptr_t>(ptr) | bits::tag_of(h));
+        }
+
+        /// Points `link` at a new address, keeping its tag.
+        void* rebase(void *link, void *new_addr, uintptr_t flags) const {
+            return reinterpret_cast<void*>(
+                    (reinterpret_cast<uintptr_t>(link) & bits::tag) |
+                    reinterpret_cast<uintptr_t>(new_addr) | flags);
+        }
+
+        /// Finds the bNode whose (cleaned) `next` is the element `ptr`.
         bNode* node_before(void *ptr) const {
-            bNode *b = reinterpret_cast<bNode*>(clean(head));
+            bNode *b = bNode::of(clean(head));
 
             while (clean(b->next) != reinterpret_cast<uintptr_t>(ptr)) {
-                b = reinterpret_cast<bNode*>(clean(b->next));
+                b = bNode::of(clean(b->next));
             }
             return b;
         }
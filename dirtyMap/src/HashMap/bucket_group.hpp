@@ -0,0 +1,254 @@
+
+#ifndef FYP_MAPS_BUCKET_GROUP_HPP
+#define FYP_MAPS_BUCKET_GROUP_HPP
+
+#include <cstring>    // memcpy
+
+namespace drt {
+namespace drtx {
+
+    template<typename Key, typename Val>
+    class GroupIterator;
+
+    /**
+     * A cache line worth of bucket. The first few entries of the bucket are
+     * kept as (fingerprint, element pointer) slots inside the line itself,
+     * and only once every slot is taken do further entries spill into an
+     * ordinary dirty-bit chain. Lookups compare fingerprints first, so a
+     * miss usually never leaves the bucket array, and a hit dereferences a
+     * single element.
+     *
+     * Slot entries always point at elements. The overflow chain follows the
+     * usual Bucket rules (nodes, then an element at the tail).
+     *
+     * @tparam Key Type of key object.
+     * @tparam Val Type of mapped objects.
+     */
+    template<typename Key, typename Val>
+    struct alignas(64) BucketGroup {
+
+        using value_type  =  Val;
+        using chain_type  =  Bucket<Key, Val>;
+        using bNode       =  typename chain_type::bNode;
+        using iterator    =  GroupIterator<Key, Val>;
+        using bool_ptr    =  typename chain_type::bool_ptr;
+
+        enum { slot_count = 6 };
+
+        value_type *slots[slot_count] = { };
+        chain_type overflow;
+        // padded to 8 bytes so that all tags can be loaded as one word
+        uint8_t tags[8] = { };
+
+        /// Groups hold several entries each, so they are filled more densely.
+        static constexpr float default_max_load_factor() {
+            return 4.0;
+        }
+
+        /**
+         * Searches for an element with key = k. Elements are only
+         * dereferenced when their fingerprint matches.
+         */
+        template<typename Counter>
+        value_type* search(const Key &k, size_t h, Counter &probes) const {
+            // compare all tags at once (SWAR): bytes of x are zero where the
+            // tag matches. Free slots hold tag 0 so never match, but borrows
+            // can flag the byte above a match, hence the null check.
+            uint64_t x = load_tags() ^ (tag_of(h) * 0x0101010101010101ULL);
+            uint64_t m = (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+
+            for (; m; m &= m - 1) {
+                int i = __builtin_ctzll(m) >> 3;
+                if (i >= slot_count) break;
+                if (!slots[i]) continue;
+
+                probes();
+                if (slots[i]->first == k) return slots[i];
+            }
+
+            if (overflow.isEmpty()) return nullptr;
+            return overflow.search(k, h, probes);
+        }
+
+        value_type* search(const Key &k, size_t h) const {
+            null_probes probes;
+            return search(k, h, probes);
+        }
+
+        /// Places an element in a free slot, or at the end of the overflow chain.
+        void insert_node(value_type *element, size_t h) {
+            for (int i = 0; i < slot_count; ++i) {
+                if (!slots[i]) {
+                    slots[i] = element;
+                    tags[i] = tag_of(h);
+                    return;
+                }
+            }
+
+            overflow.insert_node(element);
+        }
+
+        /// Pushes a node onto the overflow chain. Only valid if !accepts_element().
+        void insert_node(bNode *node, size_t) {
+            overflow.insert_node(node);
+        }
+
+        /**
+         * Removes an entry. Slot entries are simply cleared; chain entries
+         * are handled as in Bucket::remove_node.
+         */
+        bool_ptr remove_node(void *to_remove, bool keep_nodes = false) {
+            int i = slot_of(to_remove);
+
+            if (i >= 0) {
+                slots[i] = nullptr;
+                tags[i] = 0;
+                return bool_ptr(true, nullptr);
+            }
+
+            return overflow.remove_node(to_remove, keep_nodes);
+        }
+
+        /// Changes an invalid element pointer (in a slot or the chain).
+        void update_element(void *old_addr, void *new_addr) {
+            int i = slot_of(old_addr);
+
+            if (i >= 0) {
+                slots[i] = static_cast<value_type*>(new_addr);
+            } else {
+                overflow.update_element(old_addr, new_addr);
+            }
+        }
+
+        /// Changes an invalid node pointer; nodes only live in the chain.
+        void update_node(void *old_addr, void *new_addr) {
+            overflow.update_node(old_addr, new_addr);
+        }
+
+        iterator begin() const {
+            return iterator(this);
+        }
+
+        void clear() noexcept {
+            for (int i = 0; i < slot_count; ++i) {
+                slots[i] = nullptr;
+                tags[i] = 0;
+            }
+            overflow.clear();
+        }
+
+        /**
+         * @return true if a new entry can be stored as an element: either a
+         * slot is free, or the chain is empty and can take a tail element.
+         */
+        bool accepts_element() const noexcept {
+            return overflow.isEmpty() || slot_of(nullptr) >= 0;
+        }
+
+        /// @return true if there are no entries in this group.
+        bool isEmpty() const noexcept {
+            return overflow.isEmpty() && all_free();
+        }
+
+    private:
+        /// Slot tags are never 0, so that free slots can't match.
+        static uint8_t tag_of(size_t h) noexcept {
+            uint8_t t = static_cast<uint8_t>(fingerprint<8>(h));
+            return t ? t : 1;
+        }
+
+        uint64_t load_tags() const noexcept {
+            uint64_t t;
+            std::memcpy(&t, tags, sizeof(t));
+            return t;
+        }
+
+        /// @return index of the slot holding ptr, or -1.
+        int slot_of(const void *ptr) const noexcept {
+            for (int i = 0; i < slot_count; ++i) {
+                if (slots[i] == ptr) return i;
+            }
+            return -1;
+        }
+
+        bool all_free() const noexcept {
+            for (int i = 0; i < slot_count; ++i) {
+                if (slots[i]) return false;
+            }
+            return true;
+        }
+    };
+
+    static_assert(sizeof(BucketGroup<int, std::pair<const int, int>>) == 64,
+                  "BucketGroup should fill exactly one cache line");
+
+    /**
+     * Iterator over the entries of a BucketGroup: the occupied slots first,
+     * then the overflow chain. `current` is null once the group is exhausted.
+     */
+    template<typename Key, typename Val>
+    class GroupIterator {
+    private:
+        using value_type = Val;
+        using group_type = BucketGroup<Key, Val>;
+        using b_iterator = BucketIterator<value_type>;
+
+        const group_type *group;
+        int slot;
+        b_iterator chain;
+
+    public:
+        void *current;
+
+        GroupIterator() : group(nullptr), slot(group_type::slot_count), chain(), current(nullptr) { }
+
+        explicit GroupIterator(const group_type *g)
+                : group(g), slot(-1), chain(), current(nullptr) {
+            ++(*this);
+        }
+
+        value_type& operator*() {
+            return *current_element();
+        }
+
+        value_type* operator->() {
+            return current_element();
+        }
+
+        /// Moves to the next occupied slot, then along the overflow chain.
+        GroupIterator& operator++() {
+            if (slot < group_type::slot_count) {
+                while (++slot < group_type::slot_count) {
+                    if (group->slots[slot]) {
+                        current = group->slots[slot];
+                        return *this;
+                    }
+                }
+
+                chain = group->overflow.begin();
+            } else {
+                ++chain;
+            }
+
+            current = chain.current;
+            return *this;
+        }
+
+        value_type* current_element() const noexcept {
+            if (slot < group_type::slot_count) return static_cast<value_type*>(current);
+            return chain.current_element();
+        }
+
+        bool operator==(const GroupIterator &other) const {
+            return current == other.current;
+        }
+
+        bool operator!=(const GroupIterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_BUCKET_GROUP_HPP
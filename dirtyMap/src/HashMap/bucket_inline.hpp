@@ -0,0 +1,231 @@
+
+#ifndef FYP_MAPS_BUCKET_INLINE_HPP
+#define FYP_MAPS_BUCKET_INLINE_HPP
+
+#include <type_traits>
+
+namespace drt {
+namespace drtx {
+
+    template<typename Key, typename Val>
+    class InlineIterator;
+
+    /**
+     * True for pairs small and simple enough to live in the bucket array:
+     * trivially copyable parts, and no bigger than the pointer they replace.
+     */
+    template<typename Val>
+    struct inline_eligible : std::false_type { };
+
+    template<typename K, typename M>
+    struct inline_eligible<std::pair<const K, M>> : std::integral_constant<bool,
+            std::is_trivially_copyable<K>::value &&
+            std::is_trivially_copyable<M>::value &&
+            sizeof(std::pair<const K, M>) <= sizeof(void*)> { };
+
+    /**
+     * Bucket that stores its first element in the bucket array itself. Only
+     * collisions are spilled, as nodes, into the node pool; the element pool
+     * is never used. `next` is null for an empty bucket, and otherwise is
+     * the first spilled node (or null) with the low bit set.
+     *
+     * @tparam Key Type of key object.
+     * @tparam Val Type of mapped objects.
+     */
+    template<typename Key, typename Val>
+    struct InlineBucket {
+
+        static_assert(std::is_trivially_destructible<Val>::value,
+                      "InlineBucket elements are moved by rehashing without fix-ups");
+
+        using value_type  =  Val;
+        using bNode       =  _bNode<value_type>;
+        using iterator    =  InlineIterator<Key, Val>;
+        using bool_ptr    =  std::pair<bool, bNode*>;
+
+        typename std::aligned_storage<sizeof(Val), alignof(Val)>::type storage;
+        void *next = nullptr;
+
+        static constexpr float default_max_load_factor() {
+            return 1.0;
+        }
+
+        /**
+         * Searches for an element with key = k. The inline element is read
+         * from the bucket array, so only spilled nodes count as probes.
+         */
+        template<typename Counter>
+        value_type* search(const Key &k, size_t, Counter &probes) const {
+            if (!next) return nullptr;
+            if (slot()->first == k) return slot();
+
+            for (bNode *n = first_node(); n; n = static_cast<bNode*>(n->next)) {
+                probes();
+                if (n->element.first == k) return &n->element;
+            }
+
+            return nullptr;
+        }
+
+        value_type* search(const Key &k, size_t h = 0) const {
+            null_probes probes;
+            return search(k, h, probes);
+        }
+
+        /// @return the storage for this bucket's inline element.
+        value_type* slot() const noexcept {
+            return reinterpret_cast<value_type*>(const_cast<decltype(storage)*>(&storage));
+        }
+
+        /// Marks the inline element (already constructed in slot()) as present.
+        void insert_node(value_type *, size_t = 0) {
+            next = link(nullptr);
+        }
+
+        /// Pushes a node onto the spill list. Should not be used on an empty bucket.
+        void insert_node(bNode *node, size_t = 0) {
+            node->next = first_node();
+            next = link(node);
+        }
+
+        /**
+         * Removes an entry without destroying it. If the inline element is
+         * removed while nodes remain, the first node is returned so that
+         * Hashmap can move it into the slot (followed by update_element).
+         */
+        bool_ptr remove_node(void *to_remove, bool = false) {
+            if (to_remove == slot()) {
+                bNode *first = first_node();
+                if (!first) next = nullptr;
+                return bool_ptr(true, first);
+            }
+
+            bNode *r = bNode::of(to_remove);
+            bNode *n = first_node();
+
+            if (n == r) {
+                next = link(r->next);
+            } else {
+                while (n->next != r) n = static_cast<bNode*>(n->next);
+                n->next = r->next;
+            }
+
+            r->next = nullptr;
+            return bool_ptr(false, nullptr);
+        }
+
+        /**
+         * Called once the first node's element (old_addr) has been moved
+         * into the inline slot: unlinks the node from the spill list.
+         */
+        void update_element(void *old_addr, void *) {
+            next = link(bNode::of(old_addr)->next);
+        }
+
+        /// Changes an invalid node pointer to the correct one.
+        void update_node(void *old_addr, void *new_addr) {
+            bNode *n = first_node();
+
+            if (n == old_addr) {
+                next = link(new_addr);
+            } else {
+                while (n->next != old_addr) n = static_cast<bNode*>(n->next);
+                n->next = new_addr;
+            }
+        }
+
+        iterator begin() const {
+            return iterator(this);
+        }
+
+        /// Destroys the inline element and forgets any nodes.
+        void clear() noexcept {
+            if (next) slot()->~value_type();
+            next = nullptr;
+        }
+
+        bool accepts_element() const noexcept {
+            return isEmpty();
+        }
+
+        bool isEmpty() const noexcept {
+            return next == nullptr;
+        }
+
+        /// @return the first spilled node, if any.
+        bNode* first_node() const noexcept {
+            return reinterpret_cast<bNode*>(reinterpret_cast<uintptr_t>(next) & ~uintptr_t(1));
+        }
+
+    private:
+        static void* link(void *node) noexcept {
+            return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(node) | 1);
+        }
+    };
+
+    /// Buckets that keep elements in the bucket array rather than elem_alloc.
+    template<typename B>
+    struct stores_inline : std::false_type { };
+
+    template<typename Key, typename Val>
+    struct stores_inline<InlineBucket<Key, Val>> : std::true_type { };
+
+    /**
+     * Iterator over an InlineBucket: the inline element, then spilled nodes.
+     * `current` is null once the bucket is exhausted.
+     */
+    template<typename Key, typename Val>
+    class InlineIterator {
+    private:
+        using value_type  = Val;
+        using bucket_type = InlineBucket<Key, Val>;
+        using node        = _bNode<value_type>;
+
+        node *n;
+        bool in_slot;
+
+    public:
+        void *current;
+
+        InlineIterator() : n(nullptr), in_slot(false), current(nullptr) { }
+
+        explicit InlineIterator(const bucket_type *b)
+                : n(b->first_node()), in_slot(!b->isEmpty()),
+                  current(in_slot ? b->slot() : nullptr) { }
+
+        value_type& operator*() {
+            return *current_element();
+        }
+
+        value_type* operator->() {
+            return current_element();
+        }
+
+        InlineIterator& operator++() {
+            if (in_slot) {
+                in_slot = false;
+            } else {
+                n = static_cast<node*>(n->next);
+            }
+
+            current = n ? &n->element : nullptr;
+            return *this;
+        }
+
+        value_type* current_element() const noexcept {
+            return static_cast<value_type*>(current);
+        }
+
+        bool operator==(const InlineIterator &other) const {
+            return current == other.current;
+        }
+
+        bool operator!=(const InlineIterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_BUCKET_INLINE_HPP
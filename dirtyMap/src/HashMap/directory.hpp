@@ -0,0 +1,280 @@
+#ifndef FYP_MAPS_DIRECTORY_HPP
+#define FYP_MAPS_DIRECTORY_HPP
+
+#include <vector>
+#include <new>        // placement new
+#include <utility>    // swap
+#include <iterator>   // forward_iterator_tag
+
+#include "dirtyMap/Allocator.hpp"  // aligned_allocator
+
+namespace drt {
+namespace drtx {
+
+    /// true_type if a bucket directory grows by splitting one bucket at a time.
+    template<typename Directory>
+    struct splits_buckets : std::false_type { };
+
+    /// @return the bucket of a flat array that hash h belongs to.
+    template<typename T, typename A>
+    inline size_t index_of(const std::vector<T, A> &v, size_t h) noexcept {
+        return h % v.capacity();
+    }
+
+    /// @return the bytes held by a flat bucket array.
+    template<typename T, typename A>
+    inline size_t directory_bytes(const std::vector<T, A> &v) noexcept {
+        return v.capacity() * sizeof(T);
+    }
+
+    /**
+     * Bucket directory made of fixed-size segments, addressed by linear
+     * hashing. A round starts with `low` buckets; split() adds bucket
+     * low + p and advances the split pointer p, so a hash h lives in
+     * h % low, or h % 2low once its bucket has been split. When every
+     * bucket of the round is split, low doubles and p returns to 0.
+     *
+     * Growing never copies the directory: a new bucket lands in the last
+     * segment, and at most one segment (plus a slot in the segment table)
+     * is allocated at a time. reset() re-addresses the whole directory in
+     * place, for a full relink.
+     *
+     * @tparam T            Type of buckets, default constructed empty.
+     * @tparam SegmentBytes Bytes per segment, rounded down to a power of
+     *                      two number of buckets.
+     */
+    template<typename T, size_t SegmentBytes = 65536>
+    class SegmentedDirectory {
+
+        static constexpr size_t round_down(size_t n, size_t p = 1) {
+            return p * 2 > n ? p : round_down(n, p * 2);
+        }
+
+        static constexpr size_t per_segment = round_down(SegmentBytes / sizeof(T) ? SegmentBytes / sizeof(T) : 1);
+        static constexpr size_t mask = per_segment - 1;
+
+        static constexpr size_t shift(size_t n = per_segment, size_t s = 0) {
+            return n == 1 ? s : shift(n / 2, s + 1);
+        }
+
+        using allocator = aligned_allocator<T>;
+
+        std::vector<T*> segments;
+        size_t count = 0;
+        // linear hashing state: buckets at the start of the round, and the next to split
+        size_t low = 0;
+        size_t split_at = 0;
+
+        /// Forward iterator over the buckets in index order.
+        template<typename Dir, typename V>
+        class segment_iterator {
+            Dir *dir = nullptr;
+            size_t i = 0;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = V*;
+            using reference         = V&;
+
+            segment_iterator() = default;
+            segment_iterator(Dir *d, size_t index) : dir(d), i(index) { }
+
+            reference operator*() const {
+                return (*dir)[i];
+            }
+
+            pointer operator->() const {
+                return &(*dir)[i];
+            }
+
+            segment_iterator& operator++() {
+                ++i;
+                return *this;
+            }
+
+            segment_iterator operator++(int) {
+                segment_iterator temp(*this);
+                ++i;
+                return temp;
+            }
+
+            bool operator==(const segment_iterator &other) const {
+                return i == other.i;
+            }
+
+            bool operator!=(const segment_iterator &other) const {
+                return i != other.i;
+            }
+        };
+
+    public:
+        using value_type     = T;
+        using iterator       = segment_iterator<SegmentedDirectory, T>;
+        using const_iterator = segment_iterator<const SegmentedDirectory, const T>;
+
+        SegmentedDirectory() = default;
+
+        explicit SegmentedDirectory(size_t n) {
+            resize(n);
+            low = n;
+        }
+
+        SegmentedDirectory(const SegmentedDirectory &other)
+                : count(0), low(other.low), split_at(other.split_at) {
+            resize(other.count);
+            for (size_t i = 0; i < count; ++i) (*this)[i] = other[i];
+        }
+
+        SegmentedDirectory& operator=(const SegmentedDirectory &other) {
+            if (this != &other) {
+                SegmentedDirectory temp(other);
+                swap(temp);
+            }
+            return *this;
+        }
+
+        SegmentedDirectory(SegmentedDirectory &&other) noexcept {
+            swap(other);
+        }
+
+        SegmentedDirectory& operator=(SegmentedDirectory &&other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~SegmentedDirectory() {
+            resize(0);
+        }
+
+        T& operator[](size_t i) noexcept {
+            return segments[i >> shift()][i & mask];
+        }
+
+        const T& operator[](size_t i) const noexcept {
+            return segments[i >> shift()][i & mask];
+        }
+
+        /// @return the bucket that hash h belongs to.
+        size_t index(size_t h) const noexcept {
+            // h % 2low is h % low, or that plus low: past count, it's unsplit
+            size_t i = h % (2 * low);
+            return i < count ? i : i - low;
+        }
+
+        /**
+         * Appends the bucket paired with the next one to split, and moves
+         * the split pointer on.
+         *
+         * @return the index of the bucket to split; its entries belong in
+         *         it or in the new last bucket.
+         */
+        size_t split() {
+            size_t from = split_at;
+            resize(count + 1);
+
+            if (++split_at == low) {
+                low *= 2;
+                split_at = 0;
+            }
+            return from;
+        }
+
+        /// Empties every bucket and starts a new round of n buckets.
+        void reset(size_t n) {
+            for (size_t i = 0; i < count; ++i) (*this)[i] = T();
+            resize(n);
+            low = n;
+            split_at = 0;
+        }
+
+        size_t size() const noexcept {
+            return count;
+        }
+
+        /// As size(): every bucket is addressed.
+        size_t capacity() const noexcept {
+            return count;
+        }
+
+        size_t max_size() const noexcept {
+            return static_cast<size_t>(-1) / sizeof(T);
+        }
+
+        bool empty() const noexcept {
+            return count == 0;
+        }
+
+        /// @return the bytes of every segment and of the segment table.
+        size_t allocated_bytes() const noexcept {
+            return segments.size() * per_segment * sizeof(T) + segments.capacity() * sizeof(T*);
+        }
+
+        static constexpr size_t segment_size() {
+            return per_segment;
+        }
+
+        iterator begin() noexcept {
+            return iterator(this, 0);
+        }
+
+        iterator end() noexcept {
+            return iterator(this, count);
+        }
+
+        const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator end() const noexcept {
+            return const_iterator(this, count);
+        }
+
+        void swap(SegmentedDirectory &other) noexcept {
+            segments.swap(other.segments);
+            std::swap(count, other.count);
+            std::swap(low, other.low);
+            std::swap(split_at, other.split_at);
+        }
+
+    private:
+        /// Adds or frees whole segments so that n buckets are addressable.
+        void resize(size_t n) {
+            size_t needed = (n + mask) >> shift();
+
+            while (segments.size() > needed) {
+                for (size_t i = 0; i < per_segment; ++i) segments.back()[i].~T();
+                allocator().deallocate(segments.back(), per_segment);
+                segments.pop_back();
+            }
+
+            while (segments.size() < needed) {
+                T *segment = allocator().allocate(per_segment);
+                for (size_t i = 0; i < per_segment; ++i) new(segment + i) T();
+                segments.push_back(segment);
+            }
+
+            // buckets past the end are kept empty for the next split
+            for (size_t i = n; i < count && i < segments.size() * per_segment; ++i) (*this)[i] = T();
+            count = n;
+        }
+    };
+
+    template<typename T, size_t SegmentBytes>
+    struct splits_buckets<SegmentedDirectory<T, SegmentBytes>> : std::true_type { };
+
+    template<typename T, size_t SegmentBytes>
+    inline size_t index_of(const SegmentedDirectory<T, SegmentBytes> &d, size_t h) noexcept {
+        return d.index(h);
+    }
+
+    template<typename T, size_t SegmentBytes>
+    inline size_t directory_bytes(const SegmentedDirectory<T, SegmentBytes> &d) noexcept {
+        return d.allocated_bytes();
+    }
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_DIRECTORY_HPP
@@ -0,0 +1,213 @@
+#ifndef FYP_MAPS_GROWTH_HPP
+#define FYP_MAPS_GROWTH_HPP
+
+#include <cmath>    // exp, sqrt
+
+namespace drt {
+namespace drtx {
+
+    /// Entries a bucket holds before it chains: one, or a group's slots.
+    template<typename Bucket>
+    struct bucket_slots : std::integral_constant<size_t, 1> { };
+
+    template<typename Key, typename Val>
+    struct bucket_slots<BucketGroup<Key, Val>> : std::integral_constant<size_t, BucketGroup<Key, Val>::slot_count> { };
+
+    /**
+     * Expected share of entries that don't fit in their bucket's `slots`,
+     * when a bucket's entry count is Poisson distributed with mean `load`.
+     */
+    inline double overflow_share(double load, size_t slots) {
+        // E[min(N, slots)] = sum over k < slots of P(N > k)
+        double p = std::exp(-load), cdf = 0, kept = 0;
+
+        for (size_t k = 0; k < slots; ++k) {
+            cdf += p;
+            kept += 1 - cdf;
+            p *= load / (k + 1);
+        }
+
+        return load > 0 ? (load - kept) / load : 0;
+    }
+
+    /**
+     * What a growth policy may know about a map's layout, in bytes: a
+     * bucket, an entry stored in place (0 if the bucket itself holds it)
+     * and an entry that overflowed into a chain node.
+     */
+    template<typename Bucket, typename Node, typename Val, bool Inline>
+    struct growth_layout {
+        static constexpr size_t bucket_bytes = sizeof(Bucket);
+        static constexpr size_t entry_bytes  = Inline ? 0 : sizeof(Val);
+        static constexpr size_t node_bytes   = sizeof(Node);
+        static constexpr size_t slots        = bucket_slots<Bucket>::value;
+
+        static constexpr float default_load() {
+            return Bucket::default_max_load_factor();
+        }
+
+        /// @return the expected pool bytes per entry at mean load `load`.
+        static double pool_bytes(double load) {
+            return entry_bytes + (static_cast<double>(node_bytes) - entry_bytes) * overflow_share(load, slots);
+        }
+    };
+
+    /**
+     * Expected entries dereferenced by a successful lookup at mean load
+     * `load`. The first `slots` entries of a bucket cost one each (a group
+     * finds them by fingerprint); a chained entry at position k > slots
+     * costs k - slots + 1. With one slot this is the classic 1 + load / 2.
+     */
+    inline double hit_probes(double load, size_t slots) {
+        if (load <= 0) return 1;
+
+        double p = std::exp(-load), total = 0, probes = 0;
+        size_t last = static_cast<size_t>(load + 10 * std::sqrt(load) + 20);
+
+        // probes = cost of finding every entry of a bucket holding n
+        for (size_t n = 1; n <= last; ++n) {
+            p *= load / n;
+            probes += n > slots ? n - slots + 1 : 1;
+            total += p * probes;
+        }
+
+        return total / load;
+    }
+
+    /// Smallest prime no less than n (trial division: cheap next to a rehash).
+    inline size_t next_prime(size_t n) {
+        if (n <= 2) return 2;
+
+        for (n |= 1;; n += 2) {
+            bool prime = true;
+            for (size_t d = 3; d <= n / d; d += 2) {
+                if (n % d == 0) {
+                    prime = false;
+                    break;
+                }
+            }
+            if (prime) return n;
+        }
+    }
+
+} // namespace drtx
+
+    /**
+     * Growth policy of MapPolicy: the bucket's default load factor, and
+     * Num / Den times more buckets on each growth, always odd. The
+     * default, Num / Den = 2, gives 2n + 1 buckets.
+     */
+    template<size_t Num = 2, size_t Den = 1>
+    struct growth_factor {
+        static_assert(Num > Den && Den > 0, "growth_factor must be above 1");
+
+        template<typename Layout>
+        static float max_load_factor() {
+            return Layout::default_load();
+        }
+
+        /// @return the bucket count to grow to from `buckets`.
+        static size_t next_size(size_t buckets) {
+            size_t n = buckets / Den * Num + buckets % Den * Num / Den;
+            return (n > buckets ? n : buckets + 1) | 1;
+        }
+    };
+
+    using doubling_growth = growth_factor<>;
+
+    /**
+     * As growth_factor, but every size is prime, so keys whose hashes share
+     * a common factor with the bucket count can't cluster. Each growth
+     * costs a search for the prime, small next to the rehash itself.
+     */
+    template<size_t Num = 2, size_t Den = 1>
+    struct prime_growth : growth_factor<Num, Den> {
+        static size_t next_size(size_t buckets) {
+            return drtx::next_prime(growth_factor<Num, Den>::next_size(buckets));
+        }
+    };
+
+    /**
+     * Memory-saving mode: grows only once there are LoadPercent / 100
+     * entries per bucket, e.g. 3 for 300, so most entries sit in chains.
+     * Fewer, fuller buckets and a gentler growth factor cut the bucket
+     * array and the slack after each growth; lookups walk longer chains.
+     */
+    template<size_t LoadPercent = 300, size_t Num = 3, size_t Den = 2>
+    struct dense_growth : growth_factor<Num, Den> {
+        template<typename Layout>
+        static float max_load_factor() {
+            return LoadPercent / 100.0f;
+        }
+    };
+
+    /**
+     * Picks the load factor from a model of the layout: the one using the
+     * fewest bytes per entry among those whose expected successful lookup
+     * dereferences at most CostPercent / 100 entries. It models
+     *
+     *   bytes(a) = bucket / a + entry + (node - entry) * overflow(a)
+     *
+     * for a load factor a, with Poisson bucket occupancy, and its cost
+     * with hit_probes(). Chains cost a node per overflowing entry, so the
+     * best load factor depends on the layout: with the default target of
+     * 1.5, plain buckets get 1 and 64 byte groups 6.5.
+     */
+    template<size_t CostPercent = 150, size_t Num = 2, size_t Den = 1>
+    struct model_growth : growth_factor<Num, Den> {
+        static_assert(CostPercent >= 100, "a lookup dereferences at least one entry");
+
+        template<typename Layout>
+        static float max_load_factor() {
+            static const float best = fit(Layout::bucket_bytes, Layout::entry_bytes, Layout::node_bytes,
+                                          Layout::slots);
+            return best;
+        }
+
+        /// @return bytes per entry the model expects at load factor a.
+        static double bytes_per_entry(double a, size_t bucket, size_t entry, size_t node, size_t slots) {
+            return bucket / a + entry + (static_cast<double>(node) - entry) * drtx::overflow_share(a, slots);
+        }
+
+    private:
+        static float fit(size_t bucket, size_t entry, size_t node, size_t slots) {
+            double max_cost = CostPercent / 100.0;
+            double best = 0.25, best_bytes = bytes_per_entry(best, bucket, entry, node, slots);
+
+            // quarter steps up to 16 entries per bucket
+            for (double a = 0.5; a <= 16 && drtx::hit_probes(a, slots) <= max_cost; a += 0.25) {
+                double b = bytes_per_entry(a, bucket, entry, node, slots);
+                if (b < best_bytes) {
+                    best = a;
+                    best_bytes = b;
+                }
+            }
+            return static_cast<float>(best);
+        }
+    };
+
+    /**
+     * Rehash policy of MapPolicy: entries move between the pools so that
+     * every entry alone in its bucket is a bare element and every other
+     * one a node. Uses the least memory, but a rehash moves a large share
+     * of the entries and churns both pools.
+     */
+    struct repacking_rehash {
+        static constexpr bool repacks = true;
+    };
+
+    /**
+     * Nodes are relinked where they are, even when they end up alone in a
+     * bucket, so a chain may end in a node. Only an element landing in a
+     * bucket that already holds one moves, into a node. A rehash moves far
+     * fewer entries and node addresses survive it, at the cost of the 8
+     * bytes of a node for entries that could have been elements. Chained
+     * buckets only.
+     */
+    struct in_place_rehash {
+        static constexpr bool repacks = false;
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_GROWTH_HPP
@@ -0,0 +1,176 @@
+#ifndef FYP_MAPS_HASH_HPP
+#define FYP_MAPS_HASH_HPP
+
+#include <cstdint>
+#include <cstring>      // memcpy
+#include <string>
+#include <functional>   // std::hash
+#include <type_traits>  // enable_if, is_integral, is_enum
+
+namespace drt {
+namespace drtx {
+
+    /// Odd constants with balanced bits, shared by the mixers below.
+    constexpr uint64_t secret0 = 0x2d358dccaa6c78a5ULL;
+    constexpr uint64_t secret1 = 0x8bb84b93962eacc9ULL;
+    constexpr uint64_t secret2 = 0x4b33a62ed433d4a3ULL;
+    constexpr uint64_t secret3 = 0x4d5a2da51de1aa47ULL;
+
+    /// Full 64x64 -> 128 bit product of a and b, low half in a, high in b.
+    inline void mul128(uint64_t &a, uint64_t &b) noexcept {
+#if defined(__SIZEOF_INT128__)
+        __uint128_t r = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(r);
+        b = static_cast<uint64_t>(r >> 64);
+#else
+        uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+        uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+        uint64_t t = rl + (rm0 << 32), c = t < rl;
+        uint64_t lo = t + (rm1 << 32);
+        c += lo < t;
+        a = lo;
+        b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+    }
+
+    /// Folds the 128 bit product of a and b into 64 bits.
+    inline uint64_t mix(uint64_t a, uint64_t b) noexcept {
+        mul128(a, b);
+        return a ^ b;
+    }
+
+    inline uint64_t read64(const unsigned char *p) noexcept {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+
+    inline uint64_t read32(const unsigned char *p) noexcept {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    /// 1 to 3 bytes, without branching on the length.
+    inline uint64_t read_small(const unsigned char *p, size_t k) noexcept {
+        return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+    }
+
+} // namespace drtx
+
+    /**
+     * Hashes an integer with one 128 bit multiply. Every bit of x reaches
+     * every bit of the result, so sequential or strided keys spread over
+     * the low bits used for bucket indexing.
+     */
+    inline uint64_t hash_int(uint64_t x) noexcept {
+        return drtx::mix(x ^ drtx::secret0, x ^ drtx::secret1);
+    }
+
+    /**
+     * Hashes a byte sequence, after wyhash: keys up to 16 bytes take two
+     * overlapping reads and two multiplies, longer ones 16 or 48 bytes per
+     * round. Little-endian reads, so results differ between byte orders.
+     *
+     * @param key  First byte.
+     * @param len  Number of bytes.
+     * @param seed Changes every hash, e.g. to defeat chosen keys.
+     */
+    inline uint64_t hash_bytes(const void *key, size_t len, uint64_t seed = 0) noexcept {
+        using drtx::secret0;
+        using drtx::secret1;
+        using drtx::secret2;
+        using drtx::secret3;
+        using drtx::mix;
+        using drtx::read64;
+        using drtx::read32;
+
+        const unsigned char *p = static_cast<const unsigned char *>(key);
+        uint64_t a, b;
+        seed ^= mix(seed ^ secret0, secret1);
+
+        if (len <= 16) {
+            if (len >= 4) {
+                // the two reads overlap for 4 to 7 bytes
+                size_t q = (len >> 3) << 2;
+                a = (read32(p) << 32) | read32(p + q);
+                b = (read32(p + len - 4) << 32) | read32(p + len - 4 - q);
+            } else if (len > 0) {
+                a = drtx::read_small(p, len);
+                b = 0;
+            } else {
+                a = b = 0;
+            }
+        } else {
+            size_t i = len;
+
+            if (i > 48) {
+                uint64_t s1 = seed, s2 = seed;
+                do {
+                    seed = mix(read64(p) ^ secret1, read64(p + 8) ^ seed);
+                    s1 = mix(read64(p + 16) ^ secret2, read64(p + 24) ^ s1);
+                    s2 = mix(read64(p + 32) ^ secret3, read64(p + 40) ^ s2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= s1 ^ s2;
+            }
+
+            while (i > 16) {
+                seed = mix(read64(p) ^ secret1, read64(p + 8) ^ seed);
+                p += 16;
+                i -= 16;
+            }
+
+            // the last 16 bytes, overlapping what was already mixed
+            a = read64(p + i - 16);
+            b = read64(p + i - 8);
+        }
+
+        a ^= secret1;
+        b ^= seed;
+        drtx::mul128(a, b);
+        return mix(a ^ secret0 ^ len, b ^ secret1);
+    }
+
+    /**
+     * Drop-in replacement for std::hash whose low bits are as good as its
+     * high ones. Integers, enums and pointers go through hash_int(),
+     * strings through hash_bytes(); any other type is hashed by std::hash
+     * and then mixed.
+     *
+     * @code
+     * drt::Hashmap<uint64_t, int, drt::hash<uint64_t>> m;
+     * @endcode
+     */
+    template<class T, class Enable = void>
+    struct hash {
+        size_t operator()(const T &v) const noexcept(noexcept(std::hash<T>()(v))) {
+            return static_cast<size_t>(hash_int(std::hash<T>()(v)));
+        }
+    };
+
+    template<class T>
+    struct hash<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+        size_t operator()(T v) const noexcept {
+            return static_cast<size_t>(hash_int(static_cast<uint64_t>(v)));
+        }
+    };
+
+    template<class T>
+    struct hash<T*> {
+        size_t operator()(const T *p) const noexcept {
+            return static_cast<size_t>(hash_int(reinterpret_cast<uintptr_t>(p)));
+        }
+    };
+
+    template<class CharT, class Traits, class Alloc>
+    struct hash<std::basic_string<CharT, Traits, Alloc>> {
+        size_t operator()(const std::basic_string<CharT, Traits, Alloc> &s) const noexcept {
+            return static_cast<size_t>(hash_bytes(s.data(), s.size() * sizeof(CharT)));
+        }
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_HASH_HPP
@@ -6,6 +6,7 @@
 #include <cmath>      // ceil
 #include <vector>
 #include <new>        // placement new
+#include <iterator>   // begin, end
 
 #include "dirtyMap/Allocator.hpp"
 
@@ -17,12 +18,12 @@ namespace drt {
      *
      * @tparam Key  Type of key objects.
      * @tparam Val  Type of mapped objects.
-     * @tparam Hash Type of hash function used for value lookups.
-     * @tparam S    The number of objects to store in pool nodes (will defer to
-     *              a default value if omitted)
+     * @tparam Hash   Type of hash function used for value lookups.
+     * @tparam Policy Compile-time layout options (see MapPolicy).
      */
-    template<class Key, class Val, class Hash = std::hash<Key>>
-    class Hashmap {
+    template<class Key, class Val, class Hash = std::hash<Key>, class Policy = MapPolicy>
+    class Hashmap : private drtx::SmallStore<std::pair<const Key, Val>, Policy::small_size>,
+                    private Policy::stats, private Policy::trace, private Policy::occupancy {
 
     public:
         using key_type        =  Key;
@@ -30,12 +31,37 @@ namespace drt {
         using value_type      =  std::pair<const Key, Val>;
 
     private:
-        using bucket_type     =  drtx::Bucket<key_type, value_type>;
+        using bucket_type     =  typename Policy::template bucket<key_type, value_type>;
         using bucket_node     =  drtx::_bNode<value_type>;
-        using vector_type     =  std::vector<bucket_type>;
+        using vector_type     =  typename Policy::template directory<bucket_type>;
         using v_iterator      =  typename vector_type::iterator;
-        using elem_alloc_t    =  DtPoolAllocator<value_type>;
-        using node_alloc_t    =  DtPoolAllocator<bucket_node>;
+        using pool_policy     =  typename Policy::pools;
+        using pool_size       =  typename Policy::pool_size;
+        using elem_alloc_t    =  DtPoolAllocator<value_type, drtx::buddy_mb_count<value_type>, pool_policy, pool_size>;
+        using node_alloc_t    =  DtPoolAllocator<bucket_node, drtx::buddy_mb_count<bucket_node>, pool_policy, pool_size>;
+        // true_type if elements live in the bucket array, not elem_alloc
+        using inline_tag      =  drtx::stores_inline<bucket_type>;
+        using small_type      =  drtx::SmallStore<value_type, Policy::small_size>;
+        using stats_type      =  typename Policy::stats;
+        using trace_type      =  typename Policy::trace;
+        using occupancy_type  =  typename Policy::occupancy;
+        using growth_type     =  typename Policy::growth;
+        using rehash_type     =  typename Policy::rehash;
+        using layout_type     =  drtx::growth_layout<bucket_type, bucket_node, value_type, inline_tag::value>;
+        // true_type if the directory grows by splitting a bucket at a time
+        using linear_tag      =  drtx::splits_buckets<vector_type>;
+
+        // pools never move objects, so nodes needn't become elements either
+        static constexpr bool stable = elem_alloc_t::pool_type::stable_addresses;
+        // chains may end in a node: nodes are never converted back by rehash
+        static constexpr bool keep_nodes = stable || !rehash_type::repacks;
+
+        static_assert(!(stable && inline_tag::value),
+                      "inline buckets move elements on erase; use stable pools with chained buckets");
+        static_assert(!linear_tag::value || (!inline_tag::value && drtx::bucket_slots<bucket_type>::value == 1),
+                      "linear hashing splits plain chained buckets only");
+        static_assert(rehash_type::repacks || (!inline_tag::value && drtx::bucket_slots<bucket_type>::value == 1),
+                      "in-place rehash relinks plain chained buckets only");
 
         vector_type buckets;
         node_alloc_t node_alloc;
@@ -43,19 +69,27 @@ namespace drt {
         Hash hasher;
 
         size_t _element_count = 0;
-        float _max_load_factor = 1.0;
+        float _max_load_factor = growth_type::template max_load_factor<layout_type>();
+        // load at which to grow next; above _max_load_factor while over budget
+        float _grow_at = _max_load_factor;
+        size_t _memory_budget = 0;
 
         // needs access to buckets
-        friend class drtx::HashMapIterator<Val, bucket_type, v_iterator>;
+        friend class drtx::HashMapIterator<value_type, bucket_type, v_iterator, occupancy_type>;
 
     public:
-        using iterator        =  drtx::HashMapIterator<Val, bucket_type, v_iterator>;
+        using iterator        =  drtx::HashMapIterator<value_type, bucket_type, v_iterator, occupancy_type>;
 
         // constructors & destructor
 
-        Hashmap() : buckets(1), hasher(), node_alloc(), elem_alloc() { }
+        /// Allocates nothing in small mode; otherwise a single bucket.
+        Hashmap() : buckets(small_type::capacity() ? 0 : 1), hasher(), node_alloc(), elem_alloc() {
+            occupancy().resize(bucket_count());
+        }
 
-        Hashmap(size_t n, const Hash &hf = Hash()) : buckets(n), hasher(hf), node_alloc(), elem_alloc() { }
+        Hashmap(size_t n, const Hash &hf = Hash()) : buckets(n), hasher(hf), node_alloc(), elem_alloc() {
+            occupancy().resize(bucket_count());
+        }
 
         ~Hashmap() = default;
         Hashmap(const Hashmap&) = default;
@@ -85,6 +119,76 @@ namespace drt {
             return _element_count == 0;
         }
 
+        /**
+         * Reports exactly how much memory the map holds and where: the map
+         * object, the bucket array, and the used and reserved bytes of each
+         * pool.
+         */
+        MemoryUsage memory_usage() const {
+            MemoryUsage u;
+            u.elements = size();
+            u.object_bytes = sizeof(*this);
+            u.bucket_bytes = drtx::directory_bytes(buckets) + occupancy().allocated_bytes();
+            u.element_pools = elem_alloc.usage();
+            u.node_pools = node_alloc.usage();
+            return u;
+        }
+
+        /**
+         * Snapshot of the counters kept by the policy's stats (all zero with
+         * the default no_stats), plus a histogram of bucket chain lengths
+         * computed now by walking every bucket.
+         */
+        MapStats statistics() const {
+            MapStats s;
+            static_cast<StatCounters&>(s) = stats().counters();
+            s.collected = stats_type::enabled;
+            s.chain_lengths = chain_histogram();
+            return s;
+        }
+
+        /// Zeroes the counters kept by the policy's stats.
+        void reset_statistics() {
+            stats().reset();
+        }
+
+        /**
+         * @return the events recorded by the policy's trace, oldest first
+         *         (none with the default no_trace).
+         */
+        TraceLog trace_log() const {
+            return trace().log();
+        }
+
+        /// Forgets every recorded event.
+        void clear_trace() {
+            trace().clear();
+        }
+
+        /**
+         * @return [n] = the number of buckets holding n entries. In small
+         *         mode, a single "bucket" holding every element.
+         */
+        std::vector<size_t> chain_histogram() const {
+            std::vector<size_t> hist;
+
+            if (is_small()) {
+                hist.resize(size() + 1);
+                hist[size()] = 1;
+                return hist;
+            }
+
+            for (const bucket_type &b : buckets) {
+                size_t n = 0;
+                for (auto it = b.begin(); it.current; ++it) ++n;
+
+                if (n >= hist.size()) hist.resize(n + 1);
+                hist[n] += 1;
+            }
+
+            return hist;
+        }
+
         // modifiers
 
         /**
@@ -92,13 +196,15 @@ namespace drt {
          * of buckets.
          */
         void clear() {
-            node_alloc.destroyAll();
-            elem_alloc.destroyAll();
+            small().clear();
+            release_pools(node_alloc);
+            release_pools(elem_alloc);
 
             for (bucket_type &buk : buckets) {
-                buk.head = nullptr;
+                buk.clear();
             }
 
+            occupancy().clear();
             _element_count = 0;
         }
 
@@ -109,34 +215,126 @@ namespace drt {
          * @return  The number of elements that were removed (0 or 1).
          */
         size_t erase(const Key &k) {
-            size_t index = hasher(k) % bucket_count();
-            bucket_type &b = buckets[index];
-            value_type *element = b.search(k);
+            if (is_small()) {
+                value_type *element = small_search(k);
+
+                if (!element) return 0;
+                small().erase(element);
+                _element_count -= 1;
+                return 1;
+            }
+
+            size_t h = hasher(k);
+            size_t i = bucket_index(h);
+            bucket_type &b = buckets[i];
+            value_type *element = search(b, k, h);
 
             if (!element) return 0;
-            // pair<bool, bucket_node*>
-            auto removed = b.remove_node(element);
+            erase_entry(b, element);
+            mark(i);
+            return 1;
+        }
 
-            if (removed.first) {
-                destroy_bucket_element(reinterpret_cast<void*>(element), element->first);
+        /**
+         * Removes and destroys the element at pos, without searching for it.
+         *
+         * @return An iterator to the element that followed pos.
+         */
+        iterator erase(iterator pos) {
+            v_iterator index = pos.position();
+            v_iterator e = buckets.end();
 
-                if (removed.second) {
-                    /* We removed an element, leaving a node at the tail of
-                    a bucket. This node needs to be converted to an element */
-                    // first make element from node to be replaced
-                    value_type *replacement = static_cast<value_type*>(elem_alloc.allocate());
-                    new(replacement) value_type(std::move(removed.second->element));
-                    // update bucket tail with new element
-                    b.update_element(reinterpret_cast<void*>(removed.second), replacement);
-                    // destroy node and potentially update other moved node
-                    destroy_bucket_node(reinterpret_cast<void*>(removed.second), removed.second->element.first);
+            if (value_type *element = pos.small_position()) {
+                // the last element moves into this place, and is next
+                small().erase(element);
+                _element_count -= 1;
+                return iterator(element, small().end(), e);
+            }
+
+            // objects may move, but the order within a bucket is kept
+            size_t depth = 0;
+
+            for (auto it = index->begin(); it.current != pos.current(); ++it) {
+                ++depth;
+            }
+
+            erase_entry(*index, &*pos);
+            mark(pos.bucket_number());
+
+            iterator next(index, e, pos.bucket_number(), &occupancy());
+            for (; depth; --depth) ++next;
+            return next;
+        }
+
+        /**
+         * Removes and destroys every element for which pred returns true.
+         * Elements are unlinked as they are found and the pools compacted
+         * once at the end, so this is much cheaper than erasing one by one.
+         *
+         * @param pred Called once with each value_type&.
+         * @return     The number of elements removed.
+         */
+        template<typename Pred>
+        size_t erase_if(Pred pred) {
+            if (is_small()) {
+                size_t erased = 0;
+
+                for (value_type *element = small().begin(); element != small().end();) {
+                    if (pred(*element)) {
+                        small().erase(element);
+                        ++erased;
+                    } else {
+                        ++element;
+                    }
                 }
-            } else {
-                destroy_bucket_node(reinterpret_cast<void*>(element), element->first);
+
+                _element_count -= erased;
+                return erased;
             }
 
-            _element_count -= 1;
-            return 1;
+            pending_erase pending;
+            unlink_if(pred, pending, inline_tag());
+            // every pool was walked already, so one more pass over the buckets is cheap
+            occupancy().assign(buckets);
+            return compact(pending);
+        }
+
+        /**
+         * Removes and destroys the elements with the keys in [first, last),
+         * compacting the pools once at the end as erase_if does. Missing
+         * keys are ignored.
+         *
+         * @return The number of elements removed.
+         */
+        template<typename InputIt>
+        size_t erase_batch(InputIt first, InputIt last) {
+            if (is_small()) {
+                size_t erased = 0;
+                for (; first != last; ++first) erased += erase(*first);
+                return erased;
+            }
+
+            pending_erase pending;
+
+            for (; first != last; ++first) {
+                size_t h = hasher(*first);
+                size_t i = bucket_index(h);
+                bucket_type &b = buckets[i];
+                value_type *element = search(b, *first, h);
+
+                if (element) {
+                    unlink(b, element, pending);
+                    mark(i);
+                }
+            }
+
+            return compact(pending);
+        }
+
+        /// As above, for every key in a container.
+        template<typename Keys>
+        size_t erase_batch(const Keys &keys) {
+            return erase_batch(std::begin(keys), std::end(keys));
         }
 
         // insert/emplace methods?
@@ -149,31 +347,48 @@ namespace drt {
          * @return A reference to the value associated with k.
          */
         mapped_type& operator[](const Key &k) {
-            size_t index = hasher(k) % bucket_count();
-            value_type *element = buckets[index].search(k);
+            if (is_small()) {
+                value_type *element = small_search(k);
+                if (element) return element->second;
+
+                if (!small().full()) {
+                    element = small().emplace(std::piecewise_construct,
+                            std::tuple<const Key&>(k),
+                            std::tuple<>());
+                    ++_element_count;
+                    return element->second;
+                }
+
+                // outgrown: move everything into buckets and pools
+                rehash(growth_type::next_size(small_type::capacity()));
+            }
+
+            size_t h = hasher(k);
+            value_type *element = search(buckets[bucket_index(h)], k, h);
 
             if (!element) {
                 // perform rehash first, if needed.
-                bool r = maybe_rehash();
-                if (r) index = hasher(k) % bucket_count();
-                bucket_type &b = buckets[index];
+                maybe_rehash();
+                size_t i = bucket_index(h);
+                bucket_type &b = buckets[i];
 
-                if (b.isEmpty()) {
+                if (b.accepts_element()) {
                     // piecewise construct instantiation inspired by GNU source
-                    element = static_cast<value_type*>(elem_alloc.allocate());
+                    element = new_element(b);
                     new(element) value_type(std::piecewise_construct,
                             std::tuple<const Key&>(k),
                             std::tuple<>());
-                    b.insert_node(element);
+                    b.insert_node(element, h);
                 } else {
-                    bucket_node *ptr = static_cast<bucket_node*>(node_alloc.allocate());
+                    bucket_node *ptr = static_cast<bucket_node*>(allocate(node_alloc));
                     new(ptr) bucket_node(value_type(std::piecewise_construct,
                             std::tuple<const Key&>(k),
                             std::tuple<>()));
-                    b.insert_node(ptr);
+                    b.insert_node(ptr, h);
                     element = &ptr->element;
                 }
 
+                occupancy().set(i, true);
                 ++_element_count;
             }
 
@@ -186,31 +401,47 @@ namespace drt {
          * @return A reference to the value associated with k.
          */
         mapped_type& operator[](Key &&k) {
-            size_t index = hasher(k) % bucket_count();
-            value_type *element = buckets[index].search(k);
+            if (is_small()) {
+                value_type *element = small_search(k);
+                if (element) return element->second;
+
+                if (!small().full()) {
+                    element = small().emplace(std::piecewise_construct,
+                            std::forward_as_tuple(std::move(k)),
+                            std::tuple<>());
+                    ++_element_count;
+                    return element->second;
+                }
+
+                rehash(growth_type::next_size(small_type::capacity()));
+            }
+
+            size_t h = hasher(k);
+            value_type *element = search(buckets[bucket_index(h)], k, h);
 
             if (!element) {
                 // perform rehash first, if needed.
-                bool r = maybe_rehash();
-                if (r) index = hasher(k) % bucket_count();
-                bucket_type &b = buckets[index];
+                maybe_rehash();
+                size_t i = bucket_index(h);
+                bucket_type &b = buckets[i];
 
-                if (b.isEmpty()) {
+                if (b.accepts_element()) {
                     // piecewise construct instantiation inspired by GNU source
-                    element = static_cast<value_type*>(elem_alloc.allocate());
+                    element = new_element(b);
                     new(element) value_type(std::piecewise_construct,
                             std::forward_as_tuple(std::move(k)),
                             std::tuple<>());
-                    b.insert_node(element);
+                    b.insert_node(element, h);
                 } else {
-                    bucket_node *ptr = static_cast<bucket_node*>(node_alloc.allocate());
+                    bucket_node *ptr = static_cast<bucket_node*>(allocate(node_alloc));
                     new(ptr) bucket_node(value_type(std::piecewise_construct,
                             std::forward_as_tuple(std::move(k)),
                             std::tuple<>()));
-                    b.insert_node(ptr);
+                    b.insert_node(ptr, h);
                     element = &ptr->element;
                 }
 
+                occupancy().set(i, true);
                 ++_element_count;
             }
 
@@ -226,8 +457,18 @@ namespace drt {
          * the map, throw an out_of_range error.
          */
         mapped_type& at(const Key &k) {
-            size_t index = hasher(k) % bucket_count();
-            value_type *element = buckets[index].search(k);
+            value_type *element = find_element(k);
+
+            if (!element) {
+                throw std::out_of_range("Hashmap::at");
+            }
+
+            return element->second;
+        }
+
+        /// @copydoc at(const Key&)
+        const mapped_type& at(const Key &k) const {
+            value_type *element = find_element(k);
 
             if (!element) {
                 throw std::out_of_range("Hashmap::at");
@@ -244,8 +485,7 @@ namespace drt {
          * As there can be no duplicate key, this will only return 1 or 0.
          */
         size_t count(const Key &k) const {
-            size_t index = hasher(k) % bucket_count();
-            value_type *element = buckets[index].search(k);
+            value_type *element = find_element(k);
 
             if (element) {
                 return 1;
@@ -253,6 +493,23 @@ namespace drt {
             return 0;
         }
 
+        /**
+         * Instrumentation for comparing bucket layouts.
+         *
+         * @param k The key to look up.
+         * @return The number of stored entries dereferenced while searching
+         *         for k, whether or not it is found.
+         */
+        size_t probe_count(const Key &k) const {
+            // the small mode never leaves the map object
+            if (is_small()) return 0;
+
+            size_t h = hasher(k);
+            drtx::probe_counter probes;
+            buckets[bucket_index(h)].search(k, h, probes);
+            return probes.n;
+        }
+
         // rehashing
 
         /// Returns maximum ratio of elements to buckets.
@@ -263,10 +520,40 @@ namespace drt {
         /// Setter for the maximum load factor.
         void max_load_factor(float f) {
             _max_load_factor = f;
+            _grow_at = f;
+        }
+
+        /**
+         * Caps the memory the map may hold, in bytes, 0 for no cap. Before
+         * each growth the map estimates the bytes it would hold: its pools,
+         * the old and new bucket arrays side by side during the rehash, and
+         * the pool growth needed to fill the new array to its load factor.
+         * If that exceeds the budget, it doesn't grow and lets the load
+         * factor rise by a quarter before trying again, trading longer
+         * chains for memory. Only the bucket array is held back: inserts
+         * always succeed, so pools keep growing with the elements.
+         */
+        void set_memory_budget(size_t bytes) {
+            _memory_budget = bytes;
+            _grow_at = _max_load_factor;
+        }
+
+        /// @return the budget set by set_memory_budget(), 0 if none.
+        size_t memory_budget() const noexcept {
+            return _memory_budget;
+        }
+
+        /**
+         * @return true if the memory budget has held back growth, so the
+         *         load factor may exceed max_load_factor().
+         */
+        bool over_budget() const noexcept {
+            return _grow_at > _max_load_factor;
         }
 
         /// Returns the current ratio of elements to buckets.
         float load_factor() const noexcept {
+            if (!bucket_count()) return 0;
             return static_cast<float>(size()) / static_cast<float>(bucket_count());
         }
 
@@ -281,14 +568,38 @@ namespace drt {
             // no point rehashing to smaller size.
             if (new_size <= bucket_count()) return;
 
-            vector_type temp(new_size);
+            relink(new_size);
+        }
 
-            // put elements from old vector into new bucket locations
-            // in new vector. Ordering of these methods is important!
-            reassign_elements(temp, new_size);
-            reassign_nodes(temp, new_size);
+        /**
+         * Rewrites the pools so that entries lie in bucket order: walking
+         * the buckets, as iteration does, then reads each pool front to
+         * back, and the nodes of a chain are adjacent. Worth calling once a
+         * long build has scattered entries across the pools.
+         *
+         * Entries move, so references and iterators are invalidated.
+         * Buckets keep their entries, though not always in the same order.
+         */
+        void optimize_layout() {
+            if (is_small()) return;
 
-            buckets.swap(temp);
+            node_alloc_t old_nodes(std::move(node_alloc));
+            elem_alloc_t old_elems(std::move(elem_alloc));
+            node_alloc = node_alloc_t();
+            elem_alloc = elem_alloc_t();
+
+            std::vector<value_type*> chain;
+
+            for (bucket_type &b : buckets) {
+                chain.clear();
+                for (auto it = b.begin(); it.current; ++it) chain.push_back(it.current_element());
+
+                if (!chain.empty()) lay_out(b, chain, inline_tag());
+            }
+
+            // every object was relocated out of the old pools
+            old_nodes.forgetAll();
+            old_elems.forgetAll();
         }
 
         // iterators
@@ -296,70 +607,527 @@ namespace drt {
         iterator begin() {
             v_iterator b = buckets.begin();
             v_iterator e = buckets.end();
-            return iterator(b, e);
+            if (is_small()) return iterator(small().begin(), small().end(), e);
+            return iterator(b, e, 0, &occupancy());
         }
 
         iterator end() {
             v_iterator e = buckets.end();
-            return iterator(e, e);
+            if (is_small()) return iterator(small().end(), small().end(), e);
+            return iterator(e, e, bucket_count(), &occupancy());
         }
 
     private:
+        /// Rebuilds every bucket from the pools into new_size buckets.
+        void relink(size_t new_size) {
+            typename stats_type::rehash_timer timer(stats());
+            size_t old_size = bucket_count();
+            trace().record(TraceEvent::rehash_begin, TraceEvent::none, old_size, new_size);
+            relink(new_size, linear_tag());
+            occupancy().assign(buckets);
+            trace().record(TraceEvent::rehash_end, TraceEvent::none, old_size, new_size);
+        }
+
+        /// Relinks into a new array, swapped in once complete.
+        void relink(size_t new_size, std::false_type) {
+            vector_type temp(new_size);
+
+            // put elements from old vector into new bucket locations
+            // in new vector. Ordering of these methods is important!
+            reassign_elements(temp, inline_tag());
+            reassign_nodes(temp);
+            adopt_small(temp);
+
+            buckets.swap(temp);
+        }
+
+        /**
+         * A segmented directory is emptied and resized in place instead:
+         * chained entries are all found by sweeping the pools, so the old
+         * buckets aren't needed, and no second directory is allocated.
+         */
+        void relink(size_t new_size, std::true_type) {
+            buckets.reset(new_size);
+
+            reassign_elements(buckets, inline_tag());
+            reassign_nodes(buckets);
+            adopt_small(buckets);
+        }
+
+        /// @return the bucket that hash h belongs to.
+        size_t bucket_index(size_t h) const noexcept {
+            return drtx::index_of(buckets, h);
+        }
+
+        /// @return true while the elements live in the map object itself.
+        bool is_small() const noexcept {
+            return small_type::capacity() && buckets.empty();
+        }
+
+        small_type& small() noexcept {
+            return *this;
+        }
+
+        const small_type& small() const noexcept {
+            return *this;
+        }
+
+        stats_type& stats() noexcept {
+            return *this;
+        }
+
+        const stats_type& stats() const noexcept {
+            return *this;
+        }
+
+        trace_type& trace() noexcept {
+            return *this;
+        }
+
+        const trace_type& trace() const noexcept {
+            return *this;
+        }
+
+        occupancy_type& occupancy() noexcept {
+            return *this;
+        }
+
+        const occupancy_type& occupancy() const noexcept {
+            return *this;
+        }
+
+        /// Updates the occupancy bit of bucket i after entries left it.
+        void mark(size_t i) {
+            if (occupancy_type::enabled) occupancy().set(i, !buckets[i].isEmpty());
+        }
+
+        static constexpr TraceEvent::pool_type pool_of(const elem_alloc_t&) {
+            return TraceEvent::elements;
+        }
+
+        static constexpr TraceEvent::pool_type pool_of(const node_alloc_t&) {
+            return TraceEvent::nodes;
+        }
+
+        value_type* find_element(const Key &k) const {
+            if (is_small()) return small_search(k);
+
+            size_t h = hasher(k);
+            return search(buckets[bucket_index(h)], k, h);
+        }
+
+        /// Searches b for k, counting the probes if statistics are kept.
+        value_type* search(const bucket_type &b, const Key &k, size_t h) const {
+            if (!stats_type::enabled) return b.search(k, h);
+
+            drtx::probe_counter probes;
+            value_type *element = b.search(k, h, probes);
+            stats().lookup(element != nullptr, probes.n);
+            return element;
+        }
+
+        value_type* small_search(const Key &k) const {
+            value_type *element = small().find(k);
+            stats().lookup(element != nullptr, 0);
+            return element;
+        }
+
+        /// @return a block from alloc, counting and tracing any pool this creates.
+        template<typename Alloc>
+        void* allocate(Alloc &alloc) {
+            if (!stats_type::enabled && !trace_type::enabled) return alloc.allocate();
+
+            size_t pools = alloc.pool_count();
+            void *ptr = alloc.allocate();
+
+            if (alloc.pool_count() != pools) {
+                stats().pool_created();
+                trace().record(TraceEvent::pool_created, pool_of(alloc), pools, alloc.capacity_bytes());
+            }
+            return ptr;
+        }
+
+        /// Destroys everything in alloc and frees its pools.
+        template<typename Alloc>
+        void release_pools(Alloc &alloc) {
+            if (trace_type::enabled && alloc.pool_count()) {
+                trace().record(TraceEvent::pool_released, pool_of(alloc), alloc.pool_count(), alloc.capacity_bytes());
+            }
+            alloc.destroyAll();
+        }
+
+        /// Counts and traces an object moved by erase, once its bucket is fixed.
+        void moved(TraceEvent::pool_type pool, const void *from, const void *to) {
+            stats().erase_fixup();
+            trace().record(TraceEvent::element_moved, pool,
+                           reinterpret_cast<uintptr_t>(from), reinterpret_cast<uintptr_t>(to));
+        }
+
+        /// Relocates an element into a new node, not yet linked into a bucket.
+        static void relocate(bucket_node *node, value_type *element) {
+            relocate(node, element, drtx::trivially_relocatable<value_type>());
+        }
+
+        static void relocate(bucket_node *node, value_type *element, std::true_type) noexcept {
+            drtx::relocate(&node->element, element);
+            node->next = nullptr;
+        }
+
+        static void relocate(bucket_node *node, value_type *element, std::false_type) {
+            new(node) bucket_node(std::move(*element));
+            element->~value_type();
+        }
+
+        /**
+         * Rebuilds b from `chain`, its entries in iteration order, in the
+         * new pools. The last entries become elements while b takes them,
+         * as on insert; the rest become nodes.
+         */
+        void lay_out(bucket_type &b, std::vector<value_type*> &chain, std::false_type) {
+            size_t n = chain.size();
+            b.clear();
+
+            while (n && b.accepts_element()) {
+                value_type *element = chain[--n];
+                size_t h = hasher(element->first);
+                value_type *ele_ptr = new_element(b);
+                drtx::relocate(ele_ptr, element);
+                b.insert_node(ele_ptr, h);
+            }
+
+            lay_out_nodes(b, chain, 0, n);
+        }
+
+        /// The inline element stays in the bucket; only spilled nodes move.
+        void lay_out(bucket_type &b, std::vector<value_type*> &chain, std::true_type) {
+            // forgets the spill list, keeping the inline element
+            b.insert_node(b.slot());
+            lay_out_nodes(b, chain, 1, chain.size());
+        }
+
+        /// Moves chain[first, last) into nodes allocated in that order, then links them.
+        void lay_out_nodes(bucket_type &b, std::vector<value_type*> &chain, size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                bucket_node *node_ptr = static_cast<bucket_node*>(allocate(node_alloc));
+                relocate(node_ptr, chain[i]);
+                chain[i] = &node_ptr->element;
+            }
+
+            // insert_node pushes onto the front
+            while (last-- > first) {
+                value_type *element = chain[last];
+                b.insert_node(bucket_node::of(element), hasher(element->first));
+            }
+        }
+
+        /// Moves the elements of the small mode into buckets and pools.
+        void adopt_small(vector_type &vec) {
+            for (value_type &element : small()) {
+                size_t h = hasher(element.first);
+                bucket_type &b = vec[drtx::index_of(vec, h)];
+
+                if (b.accepts_element()) {
+                    value_type *ele_ptr = new_element(b);
+                    new(ele_ptr) value_type(std::move(element));
+                    b.insert_node(ele_ptr, h);
+                } else {
+                    bucket_node *node_ptr = static_cast<bucket_node*>(allocate(node_alloc));
+                    new(node_ptr) bucket_node(std::move(element));
+                    b.insert_node(node_ptr, h);
+                }
+            }
+
+            small().clear();
+        }
+
+        /// Blocks unlinked by erase_if/erase_batch, awaiting compact().
+        struct pending_erase {
+            std::vector<void*> elems;
+            std::vector<void*> nodes;
+            size_t count = 0;
+        };
+
+        /// Removes and destroys an element found in bucket b.
+        void erase_entry(bucket_type &b, value_type *element) {
+            // pair<bool, bucket_node*>
+            auto removed = b.remove_node(element, stable);
+
+            if (removed.first) {
+                destroy_bucket_element(reinterpret_cast<void*>(element), element->first);
+
+                if (removed.second) {
+                    /* We removed an element, leaving a node at the tail of
+                    a bucket. This node needs to be converted to an element */
+                    // first make element from node to be replaced
+                    value_type *replacement = new_element(b);
+                    drtx::move_construct(replacement, &removed.second->element);
+                    // update bucket tail with new element
+                    b.update_element(&removed.second->element, replacement);
+                    moved(TraceEvent::nodes, removed.second, replacement);
+                    // destroy node and potentially update other moved node
+                    destroy_bucket_node(reinterpret_cast<void*>(removed.second), removed.second->element.first);
+                }
+            } else {
+                destroy_bucket_node(bucket_node::of(element), element->first);
+            }
+
+            _element_count -= 1;
+        }
+
+        /**
+         * Unlinks an element from b and destroys it, but leaves its block in
+         * the pool for compact(). Chains may be left ending in a node.
+         */
+        void unlink(bucket_type &b, value_type *element, pending_erase &pending) {
+            auto removed = b.remove_node(element, true);
+
+            if (removed.first) {
+                element->~value_type();
+                if (!inline_tag::value) pending.elems.push_back(element);
+
+                if (removed.second) {
+                    // inline buckets refill their slot from the first node
+                    value_type *replacement = new_element(b);
+                    // a node's link needs no destruction, only its element
+                    drtx::relocate(replacement, &removed.second->element);
+                    b.update_element(&removed.second->element, replacement);
+                    moved(TraceEvent::nodes, removed.second, replacement);
+                    pending.nodes.push_back(removed.second);
+                }
+            } else {
+                bucket_node *node = bucket_node::of(element);
+                node->~bucket_node();
+                pending.nodes.push_back(node);
+            }
+
+            ++pending.count;
+        }
+
+        /**
+         * Unlinks every pooled element matching pred. The pools are walked in
+         * memory order, and only matches are hashed to find their bucket.
+         */
+        template<typename Pred>
+        void unlink_if(Pred &pred, pending_erase &pending, std::false_type) {
+            for (auto it = elem_alloc.begin(), end_ = elem_alloc.end(); it != end_; ++it) {
+                value_type &element = *it;
+
+                if (pred(element)) {
+                    size_t h = hasher(element.first);
+                    unlink(buckets[bucket_index(h)], &element, pending);
+                }
+            }
+
+            for (auto it = node_alloc.begin(), end_ = node_alloc.end(); it != end_; ++it) {
+                value_type &element = (*it).element;
+
+                if (pred(element)) {
+                    size_t h = hasher(element.first);
+                    unlink(buckets[bucket_index(h)], &element, pending);
+                }
+            }
+        }
+
+        /// As above, walking the bucket array to find the inline elements.
+        template<typename Pred>
+        void unlink_if(Pred &pred, pending_erase &pending, std::true_type) {
+            for (bucket_type &b : buckets) {
+                size_t depth = 0;
+                auto it = b.begin();
+
+                while (it.current) {
+                    value_type *element = &*it;
+
+                    if (pred(*element)) {
+                        unlink(b, element, pending);
+                        // the slot may have been refilled; find our place again
+                        it = b.begin();
+                        for (size_t i = 0; i < depth; ++i) ++it;
+                    } else {
+                        ++it;
+                        ++depth;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Hands the blocks of a batch erase back to the pools. Objects moved
+         * into holes get their bucket pointer fixed, unless more of them
+         * would move than remain in the map, in which case it is cheaper to
+         * relink every bucket in one pass.
+         *
+         * @return The number of elements erased.
+         */
+        size_t compact(pending_erase &pending) {
+            _element_count -= pending.count;
+
+            if (!stable && pending.elems.size() + pending.nodes.size() > _element_count) {
+                auto ignore = [](void*, void*) { };
+                elem_alloc.release(pending.elems, ignore);
+                node_alloc.release(pending.nodes, ignore);
+                relink(bucket_count());
+            } else {
+                elem_alloc.release(pending.elems, [this](void *from, void *to) {
+                    size_t h = hasher(static_cast<value_type*>(to)->first);
+                    buckets[bucket_index(h)].update_element(from, to);
+                    moved(TraceEvent::elements, from, to);
+                });
+                node_alloc.release(pending.nodes, [this](void *from, void *to) {
+                    size_t h = hasher(static_cast<bucket_node*>(to)->element.first);
+                    buckets[bucket_index(h)].update_node(from, to);
+                    moved(TraceEvent::nodes, from, to);
+                });
+            }
+
+            return pending.count;
+        }
+
         bool maybe_rehash() {
             // check if rehash needed, and if so, new array size.
             std::pair<bool, size_t> need_rehash = check_rehash_needed();
 
             if (need_rehash.first) {
-                rehash(need_rehash.second);
+                grow(need_rehash.second, linear_tag());
                 return true;
             }
             return false;
         }
 
+        void grow(size_t new_size, std::false_type) {
+            rehash(new_size);
+        }
+
+        /// Linear hashing grows by one bucket, whatever new_size.
+        void grow(size_t, std::true_type) {
+            split_bucket();
+        }
+
+        /**
+         * Splits the next bucket of the linear hashing round: its entries
+         * are relinked between it and a new bucket at the end of the
+         * directory. The tail goes first, so it stays an element. Unless
+         * chains may end in a node, a bucket receiving only nodes has one
+         * of them become its element. After erase_if/erase_batch neither
+         * bucket may get a tail, so the emptied nodes are compacted together
+         * once every entry is linked again.
+         */
+        void split_bucket() {
+            size_t from = buckets.split();
+            occupancy().resize(bucket_count());
+            auto chain = buckets[from].begin();
+            buckets[from].clear();
+
+            // the tail, if any, keeps being an element
+            for (auto it = chain; it.current; ++it) {
+                if (it.at_tail()) {
+                    size_t h = hasher(it->first);
+                    buckets[bucket_index(h)].insert_node(it.current_element(), h);
+                }
+            }
+
+            pending_erase husks;
+
+            for (auto it = chain; it.current && !it.at_tail();) {
+                bucket_node *node = bucket_node::of(it.current_element());
+                // read the link before insert_node overwrites it
+                ++it;
+
+                size_t h = hasher(node->element.first);
+                bucket_type &b = buckets[bucket_index(h)];
+
+                if (!keep_nodes && b.accepts_element()) {
+                    value_type *replacement = new_element(b);
+                    // a node's link needs no destruction, only its element
+                    drtx::relocate(replacement, &node->element);
+                    b.insert_node(replacement, h);
+                    moved(TraceEvent::nodes, node, replacement);
+                    stats().rehash_move();
+                    husks.nodes.push_back(node);
+                } else {
+                    b.insert_node(node, h);
+                }
+            }
+
+            // every entry is linked again, so a node moved into a husk is found
+            if (!husks.nodes.empty()) compact(husks);
+
+            mark(from);
+            mark(bucket_count() - 1);
+        }
+
         /**
          * If a rehash is needed, pick the new size for the array.
          *
          * @return std::pair(true, new_size) if rehash is needed.
          */
         std::pair<bool, size_t> check_rehash_needed() {
-            if (load_factor() < max_load_factor()) {
+            if (load_factor() < _grow_at) {
                 return std::pair<bool, size_t>(false, 0);
             }
 
-            // quick and dirty for now.
-            size_t new_size = (bucket_count() * 2) + 1;
+            size_t new_size = linear_tag::value ? bucket_count() + 1 : growth_type::next_size(bucket_count());
+
+            if (_memory_budget && bytes_after_growth(new_size) > _memory_budget) {
+                _grow_at = load_factor() * 1.25f;
+                return std::pair<bool, size_t>(false, 0);
+            }
 
+            _grow_at = _max_load_factor;
             return std::pair<bool, size_t>(true, new_size);
         };
 
+        /**
+         * Estimates the most memory held between growing to new_size buckets
+         * and the growth after that: the larger of the rehash itself (both
+         * bucket arrays) and the pools filled up to the new load factor.
+         */
+        size_t bytes_after_growth(size_t new_size) const {
+            size_t old_buckets = bucket_count() * sizeof(bucket_type);
+            size_t new_buckets = new_size * sizeof(bucket_type);
+            size_t pools = elem_alloc.capacity_bytes() + node_alloc.capacity_bytes();
+
+            // pool bytes per entry as modelled for the current and new loads
+            size_t used = static_cast<size_t>(size() * layout_type::pool_bytes(load_factor()));
+            size_t slack = pools > used ? pools - used : 0;
+            size_t entries = static_cast<size_t>(new_size * _max_load_factor);
+            size_t more = entries > size()
+                          ? static_cast<size_t>((entries - size()) * layout_type::pool_bytes(_max_load_factor)) : 0;
+
+            // a segmented directory grows in place
+            size_t during = pools + (linear_tag::value ? 0 : old_buckets) + new_buckets;
+            size_t after = pools + new_buckets + (more > slack ? more - slack : 0);
+            return during > after ? during : after;
+        }
+
         /**
          * Takes elements stored by the allocator and assigns them to new
          * buckets in a fresh vector. If an element needs to be stored in a
          * node, it is moved to the node pool but NOT inserted into a bucket.
          *
-         * @param vec  A temporary vector used during rehashing.
-         * @param size The size of the vector.
+         * @param vec The directory being rebuilt.
          */
-        void reassign_elements(vector_type &vec, size_t size) {
+        void reassign_elements(vector_type &vec, std::false_type) {
             auto it = elem_alloc.begin();
             auto end_ = elem_alloc.end();
 
             for (; it != end_; ++it) {
                 value_type &element = *it;
-                size_t index = hasher(element.first) % size;
-                bucket_type &b = vec[index];
+                size_t h = hasher(element.first);
+                bucket_type &b = vec[drtx::index_of(vec, h)];
 
-                if (b.isEmpty()) {
+                if (b.accepts_element()) {
                     // inserting into empty bucket -> easy
-                    b.insert_node(&element);
+                    b.insert_node(&element, h);
                 } else {
                     // Need to move element from element pool into BNode in node pool.
                     // Don't insert it into a bucket yet though, as it'll get swept up
                     // in the node pool sweep.
 
                     // First make new node and put it in node pool
-                    bucket_node *node_ptr = static_cast<bucket_node*>(node_alloc.allocate());
-                    new(node_ptr) bucket_node(std::move(element));
+                    bucket_node *node_ptr = static_cast<bucket_node*>(allocate(node_alloc));
+                    relocate(node_ptr, &element);
+                    stats().rehash_move();
                     // Remove original element from element pool
                     it.deallocate(&element);
                     // The deallocated block gets refilled, so need to look at this block again
@@ -369,34 +1137,61 @@ namespace drt {
             }
         }
 
+        /**
+         * As above, for buckets that store their first element inline: the
+         * elements are found by walking the old bucket array instead.
+         */
+        void reassign_elements(vector_type &vec, std::true_type) {
+            for (bucket_type &old : buckets) {
+                if (old.isEmpty()) continue;
+
+                value_type &element = *old.slot();
+                size_t h = hasher(element.first);
+                bucket_type &b = vec[drtx::index_of(vec, h)];
+
+                if (b.accepts_element()) {
+                    new(b.slot()) value_type(std::move(element));
+                    b.insert_node(b.slot(), h);
+                } else {
+                    // left for the node pool sweep, as above
+                    bucket_node *node_ptr = static_cast<bucket_node*>(allocate(node_alloc));
+                    new(node_ptr) bucket_node(std::move(element));
+                    stats().rehash_move();
+                }
+
+                element.~value_type();
+            }
+        }
+
         /**
          * Takes nodes stored by the allocator and assigns them to new buckets
          * in a fresh vector. If a node needs to become an element, it is moved
-         * to the element pool as well as inserted into a bucket.
+         * to the element pool as well as inserted into a bucket; when nodes
+         * are kept, it is linked in where it is.
          *
-         * @param vec  A temporary vector used during rehashing.
-         * @param size The size of the vector.
+         * @param vec The directory being rebuilt.
          */
-        void reassign_nodes(vector_type &vec, size_t size) {
+        void reassign_nodes(vector_type &vec) {
             auto it = node_alloc.begin();
             auto end_ = node_alloc.end();
 
             for (; it != end_; ++it) {
                 bucket_node &node = *it;
-                size_t index = hasher(node.element.first) % size;
-                bucket_type &b = vec[index];
+                size_t h = hasher(node.element.first);
+                bucket_type &b = vec[drtx::index_of(vec, h)];
 
-                if (b.isEmpty()) {
+                if (!keep_nodes && b.accepts_element()) {
                     // inserting into empty bucket -> need to transfer pools
-                    value_type *ele_ptr = static_cast<value_type*>(elem_alloc.allocate());
-                    new(ele_ptr) value_type(std::move(node.element));
+                    value_type *ele_ptr = new_element(b);
+                    drtx::relocate(ele_ptr, &node.element);
+                    stats().rehash_move();
                     // remove node from node pool
                     it.deallocate(&node);
                     --it;
                     end_ = node_alloc.end();
-                    b.insert_node(ele_ptr);
+                    b.insert_node(ele_ptr, h);
                 } else {
-                    b.insert_node(&node);
+                    b.insert_node(&node, h);
                 }
             }
         }
@@ -411,23 +1206,47 @@ namespace drt {
             void *prev = node_alloc.destroy(ptr);
 
             if (prev) {
-                size_t to_update = hasher(k) % bucket_count();
+                size_t to_update = bucket_index(hasher(k));
                 buckets[to_update].update_node(prev, ptr);
+                moved(TraceEvent::nodes, prev, ptr);
             }
         }
 
+        /// @return storage for a new element that will be inserted into b.
+        value_type* new_element(bucket_type &b) {
+            return new_element(b, inline_tag());
+        }
+
+        value_type* new_element(bucket_type &, std::false_type) {
+            return static_cast<value_type*>(allocate(elem_alloc));
+        }
+
+        value_type* new_element(bucket_type &b, std::true_type) {
+            return b.slot();
+        }
+
+        void destroy_bucket_element(void *ptr, const Key &k) {
+            destroy_bucket_element(ptr, k, inline_tag());
+        }
+
+        /// Inline elements are not pooled, so nothing else moves.
+        void destroy_bucket_element(void *ptr, const Key &, std::true_type) {
+            static_cast<value_type*>(ptr)->~value_type();
+        }
+
         /**
          * Destroys element at `ptr` and updates invalidated bucket pointer if
          * necessary.
          */
-        void destroy_bucket_element(void *ptr, const Key &k) {
+        void destroy_bucket_element(void *ptr, const Key &k, std::false_type) {
             // When object at ptr is destroyed, a new object may be moved
             // to its address, which changes the value of k.
             void *prev = elem_alloc.destroy(ptr);
 
             if (prev) {
-                size_t to_update = hasher(k) % bucket_count();
+                size_t to_update = bucket_index(hasher(k));
                 buckets[to_update].update_element(prev, ptr);
+                moved(TraceEvent::elements, prev, ptr);
             }
         }
     };
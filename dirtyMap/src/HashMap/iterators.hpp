@@ -8,11 +8,12 @@ namespace drtx {
     /**
      * Iterator class that traverses up the list of elements stored in a bucket.
      */
-    template<typename Val>
+    template<typename Val, bool Tagged>
     class BucketIterator {
     private:
         using value_type = Val;
         using node       = _bNode<value_type>;
+        using bits       = ptr_bits<Tagged>;
 
     public:
         void *current;
@@ -42,15 +43,24 @@ namespace drtx {
             if ((p & 3) == 1) {
                 current = nullptr;
             } else {
-                node *n = reinterpret_cast<node*>(p & ~3);
-                current = n->next;
+                current = node::of(p & bits::addr)->next;
             }
             return *this;
         }
 
         value_type* current_element() const noexcept {
             return reinterpret_cast<value_type*>(
-                    reinterpret_cast<uintptr_t>(current) & ~3);
+                    reinterpret_cast<uintptr_t>(current) & bits::addr);
+        }
+
+        /// @return the tag bits of the current pointer (0 when not tagging).
+        uintptr_t tag() const noexcept {
+            return reinterpret_cast<uintptr_t>(current) & bits::tag;
+        }
+
+        /// @return true if the current entry is the element ending the list.
+        bool at_tail() const noexcept {
+            return (reinterpret_cast<uintptr_t>(current) & 3) == 1;
         }
 
         bool operator==(const BucketIterator &other) const {
@@ -67,33 +77,50 @@ namespace drtx {
      *
      * As the map is a combination of a vector and linked lists, we must
      * travel up the vector until hitting upon an element, then travel up
-     * the list at that location until reaching the end.
+     * the list at that location until reaching the end. A map in small mode
+     * has no buckets; its elements are a plain array, visited first. With
+     * an occupancy bitmap, empty buckets are skipped without reading them.
      */
-    template<typename Val, typename B, typename Vit>
+    template<typename Val, typename B, typename Vit, typename Occ = no_occupancy>
     class HashMapIterator {
     private:
         using bucket      = B;
         using value_type  = Val;
         using v_iterator  = Vit;
-        using b_iterator  = BucketIterator<value_type>;
+        using b_iterator  = typename bucket::iterator;
 
         v_iterator index;
         v_iterator end;
         b_iterator bit;
+        value_type *small = nullptr;
+        value_type *small_end = nullptr;
+        // number of the bucket at index, and the map's bitmap (if enabled)
+        size_t pos = 0;
+        const Occ *occ = nullptr;
 
     public:
-        HashMapIterator(v_iterator &b, v_iterator &e)
-                : index(b), end(e), bit() {
+        /**
+         * Iterates from bucket b, whose number is first, to e. occ is only
+         * read if Occ is enabled.
+         */
+        HashMapIterator(v_iterator &b, v_iterator &e, size_t first = 0, const Occ *o = nullptr)
+                : index(b), end(e), bit(), pos(first), occ(o) {
             // Move pointer to first location in the vector that
             // contains an element.
             shiftIndex();
         }
 
+        /// Iterates over the array [first, last) of a map in small mode.
+        HashMapIterator(value_type *first, value_type *last, v_iterator &e)
+                : index(e), end(e), bit(), small(first), small_end(last) { }
+
         value_type& operator*() {
+            if (small != small_end) return *small;
             return bit.operator*();
         }
 
         value_type* operator->() {
+            if (small != small_end) return small;
             return bit.operator->();
         }
 
@@ -102,10 +129,16 @@ namespace drtx {
          * the next non-empty bucket.
          */
         HashMapIterator& operator++() {
+            if (small != small_end) {
+                ++small;
+                return *this;
+            }
+
             ++bit;
 
             if (!bit.current) {
                 ++index;
+                ++pos;
                 shiftIndex();
             }
             return *this;
@@ -115,39 +148,68 @@ namespace drtx {
          * Increases the bucket iterator. If it is at the end of its list, find
          * the next non-empty bucket.
          */
-        HashMapIterator& operator++(int) {
-            HashMapIterator temp(index, end);
-            ++bit;
-
-            if (!bit.current) {
-                ++index;
-                shiftIndex();
-            }
+        HashMapIterator operator++(int) {
+            HashMapIterator temp(*this);
+            ++(*this);
             return temp;
         }
 
         void* current() const {
+            if (small != small_end) return small;
             return bit.current;
         }
 
-        bool operator==(const HashMapIterator<Val, B, Vit> &other) const {
-            return (index == other.index) && (bit == other.bit);
+        /// @return the current element of a map in small mode, else nullptr.
+        value_type* small_position() const {
+            return small != small_end ? small : nullptr;
+        }
+
+        /// @return position of the bucket holding the current element.
+        v_iterator position() const {
+            return index;
         }
 
-        bool operator!=(const HashMapIterator<Val, B, Vit> &other) const {
+        /// @return number of the bucket holding the current element.
+        size_t bucket_number() const {
+            return pos;
+        }
+
+        bool operator==(const HashMapIterator &other) const {
+            return (index == other.index) && (bit == other.bit) && (small == other.small);
+        }
+
+        bool operator!=(const HashMapIterator &other) const {
             return !(*this == other);
         }
 
     private:
         void shiftIndex() {
-            while (index != end && index->isEmpty()) {
-                ++index;
-            }
+            skip_empty(std::integral_constant<bool, Occ::enabled>());
 
             // Prevent a BucketIterator from being created that points
             // at an invalid memory address (valgrind finds this error).
             if (index != end) {
-                bit = b_iterator(index->head);
+                bit = index->begin();
+            }
+        }
+
+        void skip_empty(std::false_type) {
+            while (index != end && index->isEmpty()) {
+                ++index;
+                ++pos;
+            }
+        }
+
+        /// Jumps to the next set bit; a stale bit only costs a bucket read.
+        void skip_empty(std::true_type) {
+            while (index != end) {
+                size_t to = occ->next(pos);
+                std::advance(index, static_cast<std::ptrdiff_t>(to - pos));
+                pos = to;
+
+                if (index == end || !index->isEmpty()) return;
+                ++index;
+                ++pos;
             }
         }
     };
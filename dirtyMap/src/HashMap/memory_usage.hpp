@@ -0,0 +1,30 @@
+#ifndef FYP_MAPS_MEMORY_USAGE_HPP
+#define FYP_MAPS_MEMORY_USAGE_HPP
+
+namespace drt {
+
+    /**
+     * Breakdown of the memory held by a Hashmap, as returned by
+     * Hashmap::memory_usage(). All figures are in bytes unless noted.
+     */
+    struct MemoryUsage {
+        size_t elements     = 0;   ///< number of elements in the map
+        size_t object_bytes = 0;   ///< sizeof the map, small-mode storage included
+        size_t bucket_bytes = 0;   ///< the bucket array, inline elements and any occupancy bitmap
+        AllocatorUsage element_pools;
+        AllocatorUsage node_pools;
+
+        /// @return every byte held by the map.
+        size_t total_bytes() const {
+            return object_bytes + bucket_bytes + element_pools.total_bytes() + node_pools.total_bytes();
+        }
+
+        /// @return total_bytes() spread over the elements.
+        double bytes_per_element() const {
+            return elements ? static_cast<double>(total_bytes()) / elements : 0;
+        }
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_MEMORY_USAGE_HPP
@@ -0,0 +1,134 @@
+#ifndef FYP_MAPS_OCCUPANCY_HPP
+#define FYP_MAPS_OCCUPANCY_HPP
+
+#include <vector>
+#include <utility>      // move, swap
+#include <algorithm>    // fill
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace drt {
+
+    /// Default occupancy policy: iteration tests every bucket in turn.
+    struct no_occupancy {
+        static constexpr bool enabled = false;
+
+        template<typename Directory>
+        void assign(const Directory &) noexcept { }
+
+        void resize(size_t) noexcept { }
+        void set(size_t, bool) noexcept { }
+        void clear() noexcept { }
+
+        size_t next(size_t i) const noexcept {
+            return i;
+        }
+
+        size_t allocated_bytes() const noexcept {
+            return 0;
+        }
+    };
+
+    /**
+     * One bit per bucket, set while the bucket holds an entry. Iteration
+     * finds the next occupied bucket a word (64 buckets) at a time, two
+     * with SSE2, instead of reading every empty bucket on the way. Costs
+     * bucket_count() / 8 bytes and a bit update whenever a bucket becomes
+     * empty or occupied; worth it for maps iterated while sparse.
+     */
+    class occupancy_bitmap {
+        std::vector<uint64_t> words;
+        size_t bits = 0;
+
+    public:
+        static constexpr bool enabled = true;
+
+        occupancy_bitmap() = default;
+        occupancy_bitmap(const occupancy_bitmap&) = default;
+        occupancy_bitmap& operator=(const occupancy_bitmap&) = default;
+
+        occupancy_bitmap(occupancy_bitmap &&other) noexcept
+                : words(std::move(other.words)), bits(other.bits) {
+            other.words.clear();
+            other.bits = 0;
+        }
+
+        occupancy_bitmap& operator=(occupancy_bitmap &&other) noexcept {
+            words.swap(other.words);
+            std::swap(bits, other.bits);
+            return *this;
+        }
+
+        /// Sizes the bitmap to a directory and marks its occupied buckets.
+        template<typename Directory>
+        void assign(const Directory &buckets) {
+            words.assign((buckets.size() + 63) / 64, 0);
+            bits = buckets.size();
+
+            size_t i = 0;
+            for (const auto &b : buckets) {
+                if (!b.isEmpty()) words[i / 64] |= uint64_t(1) << (i & 63);
+                ++i;
+            }
+        }
+
+        /// Adds or drops buckets at the end; new ones are empty.
+        void resize(size_t n) {
+            words.resize((n + 63) / 64, 0);
+            // bits past the end stay clear, so next() never returns them
+            if (n < bits && (n & 63)) words.back() &= ~(~uint64_t(0) << (n & 63));
+            bits = n;
+        }
+
+        void set(size_t i, bool occupied) noexcept {
+            uint64_t bit = uint64_t(1) << (i & 63);
+            if (occupied) {
+                words[i / 64] |= bit;
+            } else {
+                words[i / 64] &= ~bit;
+            }
+        }
+
+        /// Marks every bucket empty.
+        void clear() noexcept {
+            std::fill(words.begin(), words.end(), 0);
+        }
+
+        /// @return the first occupied bucket at or after i, or the bucket count.
+        size_t next(size_t i) const noexcept {
+            size_t w = i / 64;
+            if (i >= bits) return bits;
+
+            uint64_t word = words[w] & (~uint64_t(0) << (i & 63));
+
+            while (!word) {
+                if (++w == words.size()) return bits;
+#ifdef __SSE2__
+                while (w + 2 <= words.size() && empty_pair(&words[w])) w += 2;
+                if (w == words.size()) return bits;
+#endif
+                word = words[w];
+            }
+
+            return w * 64 + __builtin_ctzll(word);
+        }
+
+        /// @return the bytes held by the bitmap.
+        size_t allocated_bytes() const noexcept {
+            return words.capacity() * sizeof(uint64_t);
+        }
+
+    private:
+#ifdef __SSE2__
+        static bool empty_pair(const uint64_t *p) noexcept {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+        }
+#endif
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_OCCUPANCY_HPP
@@ -0,0 +1,166 @@
+
+#ifndef FYP_MAPS_POLICIES_HPP
+#define FYP_MAPS_POLICIES_HPP
+
+#include "dirtyMap/Allocator.hpp"  // stacked_pools, stable_pools
+
+namespace drt {
+
+    /**
+     * Compile-time configuration for Hashmap. Each member selects one aspect
+     * of the map's layout or behaviour; to change one of them, derive from
+     * MapPolicy and redeclare that member.
+     */
+    struct MapPolicy {
+        /**
+         * One tagged pointer per bucket, chaining through _bNodes. Small
+         * trivially copyable pairs (no bigger than a pointer) are instead
+         * stored in the bucket array itself, see InlinePolicy.
+         */
+        template<typename Key, typename Val>
+        using bucket = typename std::conditional<drtx::inline_eligible<Val>::value,
+                drtx::InlineBucket<Key, Val>, drtx::Bucket<Key, Val>>::type;
+
+        /// Element and node pools compact themselves, moving objects on erase.
+        using pools = stacked_pools;
+
+        /**
+         * Every pool is MBUDDY_ORDER pages (1 MB). Use geometric_pool_size
+         * for maps that are usually small, or pool_bytes<N> with a larger N
+         * for very large maps.
+         */
+        using pool_size = fixed_pool_size;
+
+        /**
+         * Number of elements kept in the Hashmap object itself, searched
+         * linearly, before any bucket or pool is allocated. 0 disables this
+         * small mode, and the map starts with a single bucket instead.
+         */
+        static constexpr size_t small_size = 0;
+
+        /**
+         * Hot-path statistics. no_stats compiles to nothing; collect_stats
+         * counts lookups, probes, rehashes, pool creations and erase
+         * fix-ups, reported by Hashmap::statistics().
+         */
+        using stats = no_stats;
+
+        /**
+         * Internal event trace. no_trace records nothing; trace_ring<N>
+         * keeps the last N rehashes, pool creations and releases, and
+         * objects moved by erase, read with Hashmap::trace_log().
+         */
+        using trace = no_trace;
+
+        /**
+         * When and how far the bucket array grows. doubling_growth grows
+         * to 2n + 1 buckets at the bucket's default load factor; see
+         * growth_factor, prime_growth, dense_growth for load factors well
+         * above 1, and model_growth to derive the load factor from the
+         * layout.
+         */
+        using growth = doubling_growth;
+
+        /**
+         * The bucket array. A flat vector is rebuilt into a second array of
+         * the new size on every growth; see LinearPolicy for a directory
+         * that grows a bucket at a time.
+         */
+        template<typename Bucket>
+        using directory = std::vector<Bucket, drtx::aligned_allocator<Bucket>>;
+
+        /**
+         * Whether a rehash moves entries between the element and node
+         * pools. repacking_rehash keeps single entries as elements, using
+         * the least memory; in_place_rehash relinks nodes where they are.
+         * Stable pools always relink nodes in place.
+         */
+        using rehash = repacking_rehash;
+
+        /**
+         * How iteration finds occupied buckets. no_occupancy tests each
+         * bucket; occupancy_bitmap keeps a bit per bucket, updated on
+         * insert and erase, and skips empty ones a word at a time.
+         */
+        using occupancy = no_occupancy;
+    };
+
+    /// Always use plain dirty-bit chains, whatever the element type.
+    struct ChainedPolicy : MapPolicy {
+        template<typename Key, typename Val>
+        using bucket = drtx::Bucket<Key, Val>;
+    };
+
+    /**
+     * Each bucket holds its first element in place of the head pointer (plus
+     * a link to any collisions), saving a pointer and a cache miss for every
+     * non-empty bucket. Costs sizeof(value_type) + 8 bytes per bucket, empty
+     * or not, so it suits small elements. Requires trivially destructible
+     * elements.
+     */
+    struct InlinePolicy : MapPolicy {
+        template<typename Key, typename Val>
+        using bucket = drtx::InlineBucket<Key, Val>;
+    };
+
+    /**
+     * Buckets are 64 byte groups holding several fingerprinted element
+     * pointers before falling back to a chain. Costs 64 bytes per bucket, so
+     * the default max load factor is raised accordingly.
+     */
+    struct GroupedPolicy : MapPolicy {
+        template<typename Key, typename Val>
+        using bucket = drtx::BucketGroup<Key, Val>;
+    };
+
+    /**
+     * Opt-in for x86-64: every bucket head and node link also stores a 16
+     * bit fingerprint of the entry it points to, in the unused top bits of
+     * the address. Non-matching entries, and in particular most misses,
+     * are rejected without reading pool memory. No extra space is used.
+     */
+    struct TaggedPolicy : MapPolicy {
+        template<typename Key, typename Val>
+        using bucket = drtx::Bucket<Key, Val, true>;
+    };
+
+    /**
+     * Elements keep their address from insertion until erase, or the next
+     * rehash (which may still move an element between the element and node
+     * pools). Pools leave holes on erase instead of compacting, so erase
+     * needs no pointer fix-ups, at the cost of one bit per block and of
+     * memory that is only reused by later inserts. References returned by
+     * operator[] therefore stay valid while the map doesn't grow; call
+     * rehash() up front to avoid growth entirely.
+     */
+    struct StablePolicy : ChainedPolicy {
+        using pools = stable_pools;
+    };
+
+    /**
+     * Linear hashing over a segmented bucket directory. Past the load
+     * factor, each insert splits one bucket instead of rebuilding the
+     * whole array, so growth costs a single chain at a time, never holds
+     * two bucket arrays, and allocates at most one 64 KB segment at once.
+     * Lookups pay a second modulo for buckets already split this round.
+     * Chained buckets only; growth's next_size is ignored, as the map
+     * grows one bucket at a time.
+     */
+    struct LinearPolicy : ChainedPolicy {
+        template<typename Bucket>
+        using directory = drtx::SegmentedDirectory<Bucket>;
+    };
+
+    /**
+     * For programs holding very many maps that mostly stay tiny (e.g. one per
+     * search node): up to eight elements live inside the map with no
+     * allocation at all, and past that the pools start at 256 bytes.
+     */
+    struct SmallMapPolicy : MapPolicy {
+        static constexpr size_t small_size = 8;
+        using pool_size = geometric_pool_size<256>;
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_POLICIES_HPP
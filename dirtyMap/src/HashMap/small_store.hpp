@@ -0,0 +1,160 @@
+#ifndef FYP_MAPS_SMALL_STORE_HPP
+#define FYP_MAPS_SMALL_STORE_HPP
+
+#include <type_traits>
+#include <utility>    // move
+#include <new>        // placement new
+
+#include "dirtyMap/Allocator.hpp"  // relocate
+
+namespace drt {
+namespace drtx {
+
+    /**
+     * Room for up to N elements inside the Hashmap object itself, used while
+     * the map is small enough that a linear search beats hashing and before
+     * any bucket or pool memory is allocated. Elements are kept contiguous:
+     * erasing one moves the last element into its place.
+     *
+     * @tparam Val Type of stored elements.
+     * @tparam N   Maximum number of elements; 0 disables the small mode.
+     */
+    template<typename Val, size_t N>
+    class SmallStore {
+
+        typename std::aligned_storage<sizeof(Val), alignof(Val)>::type storage[N];
+        size_t count = 0;
+
+    public:
+        using value_type = Val;
+
+        SmallStore() = default;
+
+        SmallStore(const SmallStore&) = delete;
+        SmallStore& operator=(const SmallStore&) = delete;
+
+        SmallStore(SmallStore &&other) noexcept(std::is_nothrow_move_constructible<Val>::value) {
+            take(other);
+        }
+
+        SmallStore& operator=(SmallStore &&other) noexcept(std::is_nothrow_move_constructible<Val>::value) {
+            if (this != &other) {
+                clear();
+                take(other);
+            }
+            return *this;
+        }
+
+        ~SmallStore() {
+            clear();
+        }
+
+        static constexpr size_t capacity() {
+            return N;
+        }
+
+        size_t size() const noexcept {
+            return count;
+        }
+
+        bool full() const noexcept {
+            return count == N;
+        }
+
+        value_type* begin() const noexcept {
+            return reinterpret_cast<value_type*>(const_cast<decltype(storage)*>(&storage));
+        }
+
+        value_type* end() const noexcept {
+            return begin() + count;
+        }
+
+        /// @return the element with key k, or nullptr.
+        template<typename Key>
+        value_type* find(const Key &k) const {
+            for (value_type *e = begin(); e != end(); ++e) {
+                if (e->first == k) return e;
+            }
+            return nullptr;
+        }
+
+        /// Constructs one more element in place. Should not be used when full.
+        template<typename... Args>
+        value_type* emplace(Args&&... args) {
+            value_type *e = new(end()) value_type(std::forward<Args>(args)...);
+            ++count;
+            return e;
+        }
+
+        /// Destroys the element at e, moving the last element into its place.
+        void erase(value_type *e) {
+            value_type *last = end() - 1;
+            e->~value_type();
+
+            if (e != last) {
+                relocate(e, last);
+            }
+            --count;
+        }
+
+        void clear() noexcept {
+            for (value_type *e = begin(); e != end(); ++e) {
+                e->~value_type();
+            }
+            count = 0;
+        }
+
+    private:
+        /// Relocates every element of other, in one copy when they allow it.
+        void take(SmallStore &other) {
+            relocate_n(end(), other.begin(), other.count);
+            count += other.count;
+            other.count = 0;
+        }
+    };
+
+    /// Small mode disabled: no storage at all (Hashmap derives from this).
+    template<typename Val>
+    class SmallStore<Val, 0> {
+    public:
+        using value_type = Val;
+
+        static constexpr size_t capacity() {
+            return 0;
+        }
+
+        size_t size() const noexcept {
+            return 0;
+        }
+
+        bool full() const noexcept {
+            return true;
+        }
+
+        value_type* begin() const noexcept {
+            return nullptr;
+        }
+
+        value_type* end() const noexcept {
+            return nullptr;
+        }
+
+        template<typename Key>
+        value_type* find(const Key &) const {
+            return nullptr;
+        }
+
+        template<typename... Args>
+        value_type* emplace(Args&&...) {
+            return nullptr;
+        }
+
+        void erase(value_type *) { }
+
+        void clear() noexcept { }
+    };
+
+} // namespace drtx
+} // namespace drt
+
+#endif //FYP_MAPS_SMALL_STORE_HPP
@@ -0,0 +1,159 @@
+#ifndef FYP_MAPS_STATISTICS_HPP
+#define FYP_MAPS_STATISTICS_HPP
+
+#include <chrono>
+#include <cstdio>     // snprintf
+#include <string>
+#include <vector>
+
+namespace drt {
+
+    /// Counters kept by collect_stats, see MapPolicy::stats.
+    struct StatCounters {
+        size_t lookups       = 0;   ///< key searches, including those by operator[] and erase
+        size_t hits          = 0;
+        size_t misses        = 0;
+        size_t probes        = 0;   ///< stored entries dereferenced by those searches
+        size_t max_probes    = 0;   ///< longest single search
+        size_t rehashes      = 0;
+        size_t rehash_ns     = 0;   ///< total time spent rehashing
+        size_t rehash_moves  = 0;   ///< entries moved between the element and node pools by rehashes
+        size_t pools_created = 0;   ///< element and node pools
+        size_t erase_fixups  = 0;   ///< bucket pointers updated after erase moved an object
+    };
+
+    /**
+     * Snapshot returned by Hashmap::statistics(). The counters stay zero
+     * unless the map's policy collects them; the chain histogram is always
+     * computed, by walking every bucket when the snapshot is taken.
+     */
+    struct MapStats : StatCounters {
+        bool collected = false;             ///< whether the counters were kept
+        std::vector<size_t> chain_lengths;  ///< [n] = number of buckets holding n entries
+
+        /// @return the average number of entries dereferenced per lookup.
+        double mean_probes() const {
+            return lookups ? static_cast<double>(probes) / lookups : 0;
+        }
+
+        /// @return the share of lookups that found their key.
+        double hit_ratio() const {
+            return lookups ? static_cast<double>(hits) / lookups : 0;
+        }
+
+        /**
+         * One "<prefix><name> <value>" line per statistic, ready for a
+         * line-based metrics exporter. Histogram lines are labelled with the
+         * chain length, e.g. `dirtymap_chain_length{n="2"} 371`.
+         */
+        std::string to_text(const std::string &prefix = "dirtymap_") const {
+            std::string out;
+            auto line = [&](const char *name, size_t value) {
+                out += prefix + name + ' ' + std::to_string(value) + '\n';
+            };
+
+            if (collected) {
+                line("lookups", lookups);
+                line("hits", hits);
+                line("misses", misses);
+                line("probes", probes);
+                line("max_probes", max_probes);
+
+                char mean[32];
+                snprintf(mean, sizeof(mean), "%.4f", mean_probes());
+                out += prefix + "mean_probes " + mean + '\n';
+
+                line("rehashes", rehashes);
+                line("rehash_ns", rehash_ns);
+                line("rehash_moves", rehash_moves);
+                line("pools_created", pools_created);
+                line("erase_fixups", erase_fixups);
+            }
+
+            for (size_t n = 0; n < chain_lengths.size(); ++n) {
+                out += prefix + "chain_length{n=\"" + std::to_string(n) + "\"} "
+                       + std::to_string(chain_lengths[n]) + '\n';
+            }
+
+            return out;
+        }
+    };
+
+    /// Default statistics policy: every hook is empty and optimised away.
+    struct no_stats {
+        static constexpr bool enabled = false;
+
+        struct rehash_timer {
+            explicit rehash_timer(const no_stats &) noexcept { }
+        };
+
+        void lookup(bool, size_t) const noexcept { }
+        void pool_created() noexcept { }
+        void rehash_move() noexcept { }
+        void erase_fixup(size_t = 1) noexcept { }
+        void reset() noexcept { }
+        StatCounters counters() const noexcept { return StatCounters(); }
+    };
+
+    /**
+     * Counts lookups, probes, rehashes and the entries they move, pool
+     * creations and erase fix-ups.
+     * Costs a few increments per operation, a clock read per rehash and
+     * sizeof(StatCounters) bytes per map. Lookups are counted from const
+     * methods too, so the counters are mutable: a map collecting statistics
+     * must not be read from several threads at once.
+     */
+    struct collect_stats {
+        static constexpr bool enabled = true;
+
+        /// Adds the lifetime of the timer to the rehash counters.
+        class rehash_timer {
+            using clock_type = std::chrono::steady_clock;
+
+            StatCounters &c;
+            clock_type::time_point start;
+
+        public:
+            explicit rehash_timer(const collect_stats &s) : c(s.c), start(clock_type::now()) { }
+
+            ~rehash_timer() {
+                c.rehashes += 1;
+                c.rehash_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+            }
+        };
+
+        void lookup(bool hit, size_t probes) const noexcept {
+            c.lookups += 1;
+            c.hits += hit;
+            c.misses += !hit;
+            c.probes += probes;
+            if (probes > c.max_probes) c.max_probes = probes;
+        }
+
+        void pool_created() noexcept {
+            c.pools_created += 1;
+        }
+
+        void rehash_move() noexcept {
+            c.rehash_moves += 1;
+        }
+
+        void erase_fixup(size_t n = 1) noexcept {
+            c.erase_fixups += n;
+        }
+
+        void reset() noexcept {
+            c = StatCounters();
+        }
+
+        StatCounters counters() const noexcept {
+            return c;
+        }
+
+    private:
+        mutable StatCounters c;
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_STATISTICS_HPP
@@ -0,0 +1,177 @@
+#ifndef FYP_MAPS_TRACE_HPP
+#define FYP_MAPS_TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace drt {
+
+    /// One timestamped internal event, see MapPolicy::trace.
+    struct TraceEvent {
+        enum kind_type : uint8_t {
+            rehash_begin,     ///< a: buckets before, b: buckets after
+            rehash_end,       ///< a: buckets before, b: buckets after
+            pool_created,     ///< a: pool index, b: bytes reserved by the allocator
+            pool_released,    ///< a: pools freed, b: bytes freed
+            element_moved     ///< a: from address, b: to address
+        };
+
+        /// Which allocator a pool or move event concerns.
+        enum pool_type : uint8_t { elements, nodes, none };
+
+        uint64_t ns;          ///< steady_clock time since its epoch
+        kind_type kind;
+        pool_type pool;
+        uint64_t a;
+        uint64_t b;
+
+        const char* name() const {
+            static const char *names[] = {
+                "rehash_begin", "rehash_end", "pool_created", "pool_released", "element_moved"
+            };
+            return names[kind];
+        }
+
+        const char* pool_name() const {
+            static const char *names[] = { "elements", "nodes", "" };
+            return names[pool];
+        }
+    };
+
+    /**
+     * Events copied out of a map by Hashmap::trace_log(), oldest first.
+     * `dropped` counts older events the ring has since overwritten.
+     */
+    struct TraceLog {
+        std::vector<TraceEvent> events;
+        size_t dropped = 0;
+
+        /// @return a JSON array with one object per event.
+        std::string to_json() const {
+            std::string out = "[";
+
+            for (const TraceEvent &e : events) {
+                if (out.size() > 1) out += ',';
+                out += "\n  {\"ns\":" + std::to_string(e.ns) + ",\"event\":\"" + e.name() + '"' + args(e) + '}';
+            }
+
+            return out + "\n]\n";
+        }
+
+        /**
+         * @return the events in Chrome trace format (chrome://tracing or
+         *         Perfetto): rehashes as duration slices, the rest as
+         *         instant events on the same thread.
+         */
+        std::string to_chrome_trace(int pid = 1, int tid = 1) const {
+            std::string out = "{\"traceEvents\":[";
+            std::string ids = ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid);
+            bool first = true;
+
+            for (const TraceEvent &e : events) {
+                bool slice = e.kind == TraceEvent::rehash_begin || e.kind == TraceEvent::rehash_end;
+                const char *ph = !slice ? "i" : e.kind == TraceEvent::rehash_begin ? "B" : "E";
+
+                out += first ? "\n  " : ",\n  ";
+                first = false;
+
+                // microseconds, keeping the nanoseconds as a fraction
+                out += "{\"name\":\"" + std::string(slice ? "rehash" : e.name()) + "\",\"ph\":\"" + ph + "\",\"ts\":"
+                       + std::to_string(e.ns / 1000) + '.' + pad3(e.ns % 1000) + ids;
+                if (*ph == 'i') out += ",\"s\":\"t\"";
+                out += ",\"args\":{" + args(e).substr(1) + "}}";
+            }
+
+            return out + "\n]}\n";
+        }
+
+    private:
+        static std::string pad3(uint64_t n) {
+            std::string s = std::to_string(n);
+            return std::string(3 - s.size(), '0') + s;
+        }
+
+        static std::string hex(uint64_t n) {
+            static const char digits[] = "0123456789abcdef";
+            std::string s;
+            do { s.insert(s.begin(), digits[n & 0xf]); n >>= 4; } while (n);
+            return "\"0x" + s + '"';
+        }
+
+        /// @return ",\"key\":value" pairs for the event's payload.
+        static std::string args(const TraceEvent &e) {
+            switch (e.kind) {
+                case TraceEvent::rehash_begin:
+                case TraceEvent::rehash_end:
+                    return ",\"from\":" + std::to_string(e.a) + ",\"to\":" + std::to_string(e.b);
+                case TraceEvent::pool_created:
+                    return std::string(",\"pool\":\"") + e.pool_name() + "\",\"index\":" + std::to_string(e.a)
+                           + ",\"reserved_bytes\":" + std::to_string(e.b);
+                case TraceEvent::pool_released:
+                    return std::string(",\"pool\":\"") + e.pool_name() + "\",\"pools\":" + std::to_string(e.a)
+                           + ",\"bytes\":" + std::to_string(e.b);
+                default:
+                    return std::string(",\"pool\":\"") + e.pool_name() + "\",\"from\":" + hex(e.a)
+                           + ",\"to\":" + hex(e.b);
+            }
+        }
+    };
+
+    /// Default trace policy: nothing is recorded and every hook is empty.
+    struct no_trace {
+        static constexpr bool enabled = false;
+
+        void record(TraceEvent::kind_type, TraceEvent::pool_type, uint64_t, uint64_t) noexcept { }
+        void clear() noexcept { }
+        TraceLog log() const { return TraceLog(); }
+    };
+
+    /**
+     * Keeps the last N events in a ring buffer. Recording never locks or
+     * allocates, apart from reserving the ring with the first event; it
+     * costs a clock read and a 32 byte store. Like the map itself, the
+     * ring is not synchronised: take the log from the thread that
+     * modifies the map.
+     *
+     * @tparam N Number of events kept, a power of two.
+     */
+    template<size_t N = 4096>
+    struct trace_ring {
+        static_assert(N && (N & (N - 1)) == 0, "trace_ring size must be a power of two");
+        static constexpr bool enabled = true;
+
+        void record(TraceEvent::kind_type kind, TraceEvent::pool_type pool, uint64_t a, uint64_t b) {
+            if (ring.empty()) ring.resize(N);
+
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            ring[head++ & (N - 1)] = TraceEvent{ns, kind, pool, a, b};
+        }
+
+        void clear() noexcept {
+            head = 0;
+        }
+
+        TraceLog log() const {
+            TraceLog l;
+            size_t first = head > N ? head - N : 0;
+
+            l.dropped = first;
+            l.events.reserve(head - first);
+            for (size_t i = first; i < head; ++i) {
+                l.events.push_back(ring[i & (N - 1)]);
+            }
+
+            return l;
+        }
+
+    private:
+        std::vector<TraceEvent> ring;
+        size_t head = 0;    ///< events ever recorded since clear()
+    };
+
+} // namespace drt
+
+#endif //FYP_MAPS_TRACE_HPP
@@ -0,0 +1,95 @@
+#ifndef FYP_MAPS_ALLOC_COUNTER_HPP
+#define FYP_MAPS_ALLOC_COUNTER_HPP
+
+/*
+ * Include in ONE benchmark (after benchmark_utils.hpp) to count every heap
+ * allocation in drt_testing::heap_counters. Interposes the malloc family
+ * rather than operator new: libstdc++'s operator new calls malloc, and the
+ * pools come from posix_memalign, which operator new never sees. glibc
+ * only, as it forwards to the __libc_* entry points.
+ */
+
+#include <cstddef>
+#include <malloc.h>   // malloc_usable_size
+
+#include "benchmark_utils.hpp"
+
+extern "C" {
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void  __libc_free(void*);
+}
+
+namespace drt_testing {
+namespace {
+
+    struct enable_counting {
+        enable_counting() { heap_counters.counting = true; }
+    } _enable_counting;
+
+    void* counted(void *p) {
+        if (p) {
+            uint64_t live = heap_counters.live += malloc_usable_size(p);
+            heap_counters.allocs += 1;
+
+            uint64_t peak = heap_counters.peak.load(std::memory_order_relaxed);
+            while (live > peak && !heap_counters.peak.compare_exchange_weak(peak, live)) { }
+        }
+        return p;
+    }
+
+    void uncounted(void *p) {
+        if (p) {
+            heap_counters.live -= malloc_usable_size(p);
+            heap_counters.frees += 1;
+        }
+    }
+
+} // namespace
+} // namespace drt_testing
+
+extern "C" {
+
+    void* malloc(size_t n) noexcept {
+        return drt_testing::counted(__libc_malloc(n));
+    }
+
+    void* calloc(size_t n, size_t size) noexcept {
+        return drt_testing::counted(__libc_calloc(n, size));
+    }
+
+    void* realloc(void *p, size_t n) noexcept {
+        size_t old = p ? malloc_usable_size(p) : 0;
+        void *q = __libc_realloc(p, n);
+
+        // on failure p is untouched (and realloc(p, 0) frees it)
+        if (p && (q || !n)) {
+            drt_testing::heap_counters.live -= old;
+            drt_testing::heap_counters.frees += 1;
+        }
+        return drt_testing::counted(q);
+    }
+
+    void* memalign(size_t align, size_t n) noexcept {
+        return drt_testing::counted(__libc_memalign(align, n));
+    }
+
+    void* aligned_alloc(size_t align, size_t n) noexcept {
+        return drt_testing::counted(__libc_memalign(align, n));
+    }
+
+    int posix_memalign(void **p, size_t align, size_t n) noexcept {
+        *p = drt_testing::counted(__libc_memalign(align, n));
+        return *p || !n ? 0 : 12;  // ENOMEM
+    }
+
+    void free(void *p) noexcept {
+        drt_testing::uncounted(p);
+        __libc_free(p);
+    }
+
+}
+
+#endif //FYP_MAPS_ALLOC_COUNTER_HPP
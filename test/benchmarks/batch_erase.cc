@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Time to prune a fraction of a Hashmap<uint64_t, uint64_t>: one erase(k)
+ * per key, one erase_batch over the same keys, or one erase_if. Usage:
+ *
+ *   batch_erase <millions> [percent erased, default 50]
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+using map_type = drt::Hashmap<_t, _t>;
+
+template<class Prune>
+void prune_test(std::vector<_t> &v, size_t doomed, std::string name, Prune prune) {
+    map_type h;
+    // map each key to its position, so that erase_if can pick the same keys
+    for (size_t i = 0; i < v.size(); ++i) {
+        h[v[i]] = i;
+    }
+    std::vector<_t> keys(v.begin(), v.begin() + doomed);
+
+    auto _start = clock_type::now();
+    prune(h, keys);
+    double ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+
+    printf("| %-12s [%lu of %lu] | %8.2f ms | %6.1f ns/erase |\n",
+           name.c_str(), doomed, v.size(), ms, ms * 1e6 / doomed);
+}
+
+int main(int argc, char* argv[]) {
+
+    size_t millions = 0;
+    size_t percent = 50;
+
+    if (argc > 1) {
+        float factor = std::strtof(argv[1], nullptr);
+        if (factor <= 0.0) {
+            std::cout << "USE A POSITIVE NUMBER!!!\n";
+            return 0;
+        }
+        millions = (size_t) (1000000 * factor);
+        if (argc > 2) percent = std::strtoul(argv[2], nullptr, 10);
+    } else {
+        std::cout << "Usage: batch_erase <millions> [percent]\n";
+        return 0;
+    }
+
+    std::vector<_t> v;
+    v.reserve(millions);
+    drt_testing::fill_vector<_t>(v);
+    drt_testing::shuffle_vector<_t>(v);
+    size_t doomed = millions * percent / 100;
+
+    prune_test(v, doomed, "erase(k)", [](map_type &h, std::vector<_t> &keys) {
+        drt_testing::erase_map<_t, map_type>(keys, h);
+    });
+
+    prune_test(v, doomed, "erase_batch", [](map_type &h, std::vector<_t> &keys) {
+        h.erase_batch(keys);
+    });
+
+    prune_test(v, doomed, "erase_if", [doomed](map_type &h, std::vector<_t> &) {
+        h.erase_if([doomed](std::pair<const _t, _t> &p) { return p.second < doomed; });
+    });
+
+    return 0;
+}
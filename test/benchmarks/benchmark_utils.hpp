@@ -3,6 +3,7 @@
 #define FYP_MAPS_BENCHMARK_UTILS_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <random>
 #include <vector>
@@ -11,6 +12,15 @@
 #include <iostream>
 #include <unordered_map>
 
+#include <cmath>       // ceil
+
+#ifdef __GLIBC__
+#include <malloc.h>    // mallinfo2
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
 namespace drt_testing {
 
     using std::string;
@@ -43,6 +53,74 @@ namespace drt_testing {
         return 0;
     }
 
+    /**
+     * Bytes currently handed out by malloc, including blocks it mmaps.
+     * Unlike VmSize this sees small allocations carved from the heap, so it
+     * suits small maps. Falls back to VmSize without glibc 2.33.
+     */
+    uint64_t current_heap_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        struct mallinfo2 mi = mallinfo2();
+        return mi.uordblks + mi.hblkhd;
+#else
+        return current_process_vm();
+#endif
+    }
+
+    /// Reads a "Name:  123 kB" line of a /proc file, in bytes (0 if absent).
+    uint64_t _proc_kb(const char *path, const string &name) {
+        std::ifstream f(path);
+        string next;
+
+        while (f >> next) {
+            if (next == name) {
+                uint64_t kb = 0;
+                f >> kb;
+                return kb * 1024;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * Resident set size: pages actually touched, unlike VmSize. Uses
+     * smaps_rollup (Linux 4.14) when present, which also counts shared pages.
+     */
+    uint64_t current_rss() {
+        uint64_t rss = _proc_kb("/proc/self/smaps_rollup", "Rss:");
+        return rss ? rss : _proc_kb("/proc/self/status", "VmRSS:");
+    }
+
+    /// Highest RSS since the process started or reset_peak_rss().
+    uint64_t peak_rss() {
+        return _proc_kb("/proc/self/status", "VmHWM:");
+    }
+
+    /// Restarts peak_rss() from the current RSS, where the kernel allows it.
+    void reset_peak_rss() {
+        std::ofstream("/proc/self/clear_refs") << "5";
+    }
+
+    /**
+     * Heap counters, kept by the malloc interposers in alloc_counter.hpp
+     * when a benchmark includes it (`counting` is then true). Bytes are
+     * malloc_usable_size, i.e. what each block really occupies.
+     */
+    struct HeapCounters {
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> live{0};
+        std::atomic<uint64_t> peak{0};
+        bool counting = false;
+
+        /// Restarts the peak from the bytes live now.
+        void reset_peak() {
+            peak = live.load();
+        }
+    };
+
+    HeapCounters heap_counters;
+
     float to_mb(uint64_t kb) {
         return (float) ((double) kb / (1024 * 1024));
     }
@@ -81,13 +159,19 @@ namespace drt_testing {
         }
     };
 
+    // written by search_map so that the lookups can't be optimised away
+    volatile size_t search_sink = 0;
+
     template<class T, class HMap>
     void search_map(std::vector<T> &v, HMap &h) {
         size_t size = v.size();
+        size_t found = 0;
 
         for (size_t i = 0; i < size; ++i) {
-            h.count(v[i]);
+            found += h.count(v[i]);
         }
+
+        search_sink = found;
     };
 
     template<class T, class HMap>
@@ -183,6 +267,40 @@ namespace drt_testing {
         }
     };
 
+    /**
+     * Lookups where only 1 in `hit_every` keys is present (all misses if 0),
+     * the pattern seen in duplicate detection.
+     */
+    template<class T, class HMap>
+    struct RandomMissTest : tbase {
+        std::vector<T> v;
+        HMap &h;
+
+        RandomMissTest(HMap &_h, size_t _n, string _m, size_t hit_every = 10)
+                : tbase(_n, "RandomMissTest", _m), h(_h) {
+
+            std::vector<T> keys;
+            keys.reserve(num * 2);
+            fill_vector<T>(keys);
+
+            // first half goes in the map, the second half are misses
+            for (size_t i = 0; i < num; ++i) {
+                h[keys[i]] = 42;
+            }
+
+            v.reserve(num);
+            for (size_t i = 0; i < num; ++i) {
+                bool hit = hit_every && (i % hit_every == 0);
+                v.push_back(hit ? keys[i] : keys[num + i]);
+            }
+            shuffle_vector<T>(v);
+        }
+
+        void run() {
+            search_map(v, h);
+        }
+    };
+
     template<class T, class HMap>
     struct RandomEraseTest : tbase {
         std::vector<T> v;
@@ -207,29 +325,55 @@ namespace drt_testing {
      * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
      */
 
-    void _print_results(float _b, float _a, string _n, string _m, size_t _s) {
+    void _print_results(double _dur, string _n, string _m, size_t _s) {
         int i = printf("| %s [%lu] with %s |\n", _n.c_str(), _s, _m.c_str());
-        printf("%*c%-9s %7.2f MB %*c\n", -(i / 4), '|', "Before:", _b, i - (i / 4) - 22, '|');
-        printf("%*c%-9s %7.2f MB %*c\n", -(i / 4), '|', "After:", _a, i - (i / 4) - 22, '|');
-        printf("%*c%-9s %7.2f MB %*c\n", -(i / 4), '|', "Gain:", _a - _b, i - (i / 4) - 22, '|');
+        printf("%*c%9s %.6lf s %*c\n", -(i/3), '|', "Duration:", _dur/1000.0, i-(i/3)-22, '|');
         printf("|");
         for (int j = 0; j < i - 3; ++j) printf("#");
         printf("|\n");
     }
 
-    void _print_results(double _dur, string _n, string _m, size_t _s) {
+    void _print_memory(uint64_t rss, uint64_t peak_rss, uint64_t heap, uint64_t peak_heap, uint64_t allocs,
+                       string _n, string _m, size_t _s) {
         int i = printf("| %s [%lu] with %s |\n", _n.c_str(), _s, _m.c_str());
-        printf("%*c%9s %.6lf s %*c\n", -(i/3), '|', "Duration:", _dur/1000.0, i-(i/3)-22, '|');
+        double n = _s ? (double) _s : 1;
+        auto line = [&](const char *what, uint64_t bytes) {
+            printf("%*c%-11s %9.2f MB %7.2f B/entry %*c\n", -(i / 6), '|', what, to_mb(bytes), bytes / n,
+                   i - (i / 6) - 42, '|');
+        };
+
+        line("RSS:", rss);
+        line("Peak RSS:", peak_rss);
+        if (heap_counters.counting) {
+            line("Heap:", heap);
+            line("Peak heap:", peak_heap);
+            printf("%*c%-11s %12lu allocations %*c\n", -(i / 6), '|', "Allocs:", allocs, i - (i / 6) - 38, '|');
+        }
         printf("|");
         for (int j = 0; j < i - 3; ++j) printf("#");
         printf("|\n");
     }
 
+    /**
+     * Reports what _test.run() added: resident memory now and at its peak,
+     * and with alloc_counter.hpp included, live heap bytes now and at their
+     * peak (the old and new tables of the last rehash), and the number of
+     * allocations. All per entry as well.
+     */
     void run_memory_test(tbase &_test) {
-        float mem_before = to_mb(current_process_vm());
+        uint64_t rss_before = current_rss();
+        uint64_t heap_before = heap_counters.live;
+        uint64_t allocs_before = heap_counters.allocs;
+        reset_peak_rss();
+        heap_counters.reset_peak();
+
         _test.run();
-        float mem_after = to_mb(current_process_vm());
-        _print_results(mem_before, mem_after, _test.tname, _test.mname, _test.num);
+
+        uint64_t rss = current_rss() - rss_before;
+        uint64_t peak = peak_rss();
+        peak = peak > rss_before ? peak - rss_before : rss;
+        _print_memory(rss, peak, heap_counters.live - heap_before, heap_counters.peak - heap_before,
+                      heap_counters.allocs - allocs_before, _test.tname, _test.mname, _test.num);
     }
 
     void run_time_test(tbase &_test) {
@@ -240,6 +384,166 @@ namespace drt_testing {
         _print_results(_duration, _test.tname, _test.mname, _test.num);
     }
 
+    /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *           LATENCY HISTOGRAMS
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     */
+
+    /// Cheap timestamps: the TSC on x86-64, steady_clock elsewhere.
+    struct tick_clock {
+        static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        /// Calibrated once against steady_clock over ~20 ms.
+        static double ns_per_tick() {
+            static double scale = calibrate();
+            return scale;
+        }
+
+    private:
+        static double calibrate() {
+            using clock_type = std::chrono::steady_clock;
+            auto t0 = clock_type::now();
+            uint64_t c0 = now();
+
+            while (clock_type::now() - t0 < std::chrono::milliseconds(20)) { }
+
+            double ns = std::chrono::duration<double, std::nano>(clock_type::now() - t0).count();
+            return ns / static_cast<double>(now() - c0);
+        }
+    };
+
+    /**
+     * HDR-style histogram of nanosecond latencies: exact below 64 ns, then
+     * 32 linear buckets per power of two, so every recorded value is known
+     * to within about 3% whatever its size, in 15 KB.
+     */
+    class LatencyHistogram {
+        static constexpr unsigned sub_bits = 5;
+        static constexpr uint64_t sub_count = 1 << sub_bits;
+
+        std::vector<uint64_t> counts;
+        uint64_t total = 0;
+        uint64_t max_ns = 0;
+        double sum_ns = 0;
+
+        static size_t index_of(uint64_t ns) {
+            if (ns < 2 * sub_count) return ns;
+            unsigned shift = 63 - __builtin_clzll(ns) - sub_bits;
+            return (shift + 1) * sub_count + ((ns >> shift) - sub_count);
+        }
+
+        /// @return the largest value that maps to bucket i.
+        static uint64_t highest_in(size_t i) {
+            if (i < 2 * sub_count) return i;
+            unsigned shift = i / sub_count - 1;
+            return ((i % sub_count + sub_count + 1) << shift) - 1;
+        }
+
+    public:
+        LatencyHistogram() : counts(index_of(~uint64_t(0)) + 1) { }
+
+        void record(uint64_t ns) {
+            counts[index_of(ns)] += 1;
+            total += 1;
+            sum_ns += ns;
+            if (ns > max_ns) max_ns = ns;
+        }
+
+        uint64_t count() const {
+            return total;
+        }
+
+        uint64_t max() const {
+            return max_ns;
+        }
+
+        double mean() const {
+            return total ? sum_ns / total : 0;
+        }
+
+        /// @return the latency that p percent of the samples don't exceed.
+        uint64_t percentile(double p) const {
+            uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+            uint64_t seen = 0;
+
+            for (size_t i = 0; i < counts.size(); ++i) {
+                seen += counts[i];
+                if (seen >= target && seen) return std::min(highest_in(i), max_ns);
+            }
+            return max_ns;
+        }
+    };
+
+    /**
+     * Times op(0) .. op(n - 1) into h, one operation per sample, or the
+     * average over `batch` operations per sample when single operations
+     * are too short for the clock. Batching hides tails inside a batch.
+     */
+    template<class Op>
+    void time_each(size_t n, LatencyHistogram &h, Op op, size_t batch = 1) {
+        double scale = tick_clock::ns_per_tick();
+
+        for (size_t i = 0; i < n; i += batch) {
+            size_t end = std::min(n, i + batch);
+            uint64_t t0 = tick_clock::now();
+            for (size_t j = i; j < end; ++j) op(j);
+            uint64_t t1 = tick_clock::now();
+            h.record(static_cast<uint64_t>((t1 - t0) * scale / (end - i)));
+        }
+    }
+
+    string _format_ns(double ns) {
+        char buf[32];
+        if (ns >= 1e6) snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
+        else if (ns >= 1e3) snprintf(buf, sizeof(buf), "%.2f us", ns / 1e3);
+        else snprintf(buf, sizeof(buf), "%.0f ns", ns);
+        return buf;
+    }
+
+    void _print_latency(const LatencyHistogram &h, string _n, string _m, size_t _s) {
+        printf("| %-6s [%9lu] with %s | p50 %9s | p99 %9s | p99.9 %9s | max %9s | mean %9s |\n",
+               _n.c_str(), _s, _m.c_str(),
+               _format_ns(h.percentile(50)).c_str(), _format_ns(h.percentile(99)).c_str(),
+               _format_ns(h.percentile(99.9)).c_str(), _format_ns(h.max()).c_str(),
+               _format_ns(h.mean()).c_str());
+    }
+
+    /**
+     * Inserts n random keys into h, searches for them all in a different
+     * order, then erases them all, timing every operation, and prints the
+     * latency percentiles of each phase. Rehashes and pool creations show
+     * up as the max and the far tail of insert.
+     */
+    template<class T, class HMap>
+    void run_latency_test(HMap &h, size_t n, string map_name, size_t batch = 1) {
+        std::vector<T> v;
+        v.reserve(n);
+        fill_vector<T>(v);
+
+        LatencyHistogram insert, search, erase;
+
+        time_each(n, insert, [&](size_t i) { h[v[i]] = 42; }, batch);
+        shuffle_vector<T>(v);
+
+        size_t found = 0;
+        time_each(n, search, [&](size_t i) { found += h.count(v[i]); }, batch);
+        search_sink = found;
+
+        shuffle_vector<T>(v);
+        time_each(n, erase, [&](size_t i) { h.erase(v[i]); }, batch);
+
+        _print_latency(insert, "insert", map_name, n);
+        _print_latency(search, "search", map_name, n);
+        _print_latency(erase, "erase", map_name, n);
+    }
+
 } // namespace fyp_testing
 
 #endif //FYP_MAPS_BENCHMARK_UTILS_HPP
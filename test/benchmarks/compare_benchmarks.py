@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Compares two JSON runs of map_suite (or any Google Benchmark binary):
+
+    map_suite --benchmark_out=base.json --benchmark_out_format=json
+    ... change something, rebuild ...
+    map_suite --benchmark_out=new.json --benchmark_out_format=json
+    compare_benchmarks.py base.json new.json [--threshold 5] [--filter REGEX]
+
+Prints the change in time for every benchmark found in both runs, and
+exits with status 1 if any got slower by more than the threshold (in
+percent), so it can gate regression tracking. With --benchmark_repetitions
+the median of each benchmark is compared; otherwise the mean of its runs.
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+
+# Google Benchmark time units, in nanoseconds
+UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Returns {benchmark name: time in ns (or items/s)}."""
+    with open(path) as f:
+        runs = json.load(f)["benchmarks"]
+
+    medians, samples = {}, {}
+    for run in runs:
+        if run.get("error_occurred"):
+            continue
+
+        name = run.get("run_name", run["name"])
+        if metric == "items_per_second":
+            value = run.get("items_per_second")
+            if value is None:
+                continue
+        else:
+            value = run[metric] * UNITS[run.get("time_unit", "ns")]
+
+        if run.get("run_type") == "aggregate":
+            if run.get("aggregate_name") == "median":
+                medians[name] = value
+        else:
+            samples.setdefault(name, []).append(value)
+
+    result = {name: statistics.mean(values) for name, values in samples.items()}
+    result.update(medians)
+    return result
+
+
+def human(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return "%.2f %s" % (ns / scale, unit)
+    return "%.1f ns" % ns
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percentage slowdown reported as a regression (default 5)")
+    parser.add_argument("--metric", default="cpu_time", choices=("cpu_time", "real_time", "items_per_second"))
+    parser.add_argument("--filter", default=None, help="only compare benchmarks matching this regex")
+    args = parser.parse_args()
+
+    base = load(args.baseline, args.metric)
+    new = load(args.contender, args.metric)
+    pattern = re.compile(args.filter) if args.filter else None
+
+    names = [n for n in base if n in new and (pattern is None or pattern.search(n))]
+    if not names:
+        print("no benchmarks in common")
+        return 1
+
+    higher_is_better = args.metric == "items_per_second"
+    width = max(len(n) for n in names)
+    regressions = 0
+
+    print("%-*s  %12s  %12s  %8s" % (width, "benchmark", "baseline", "contender", "change"))
+    for name in names:
+        b, c = base[name], new[name]
+        change = 100.0 * (c - b) / b if b else 0.0
+        slower = -change if higher_is_better else change
+
+        if higher_is_better:
+            cols = ("%.3gM/s" % (b / 1e6), "%.3gM/s" % (c / 1e6))
+        else:
+            cols = (human(b), human(c))
+
+        flag = ""
+        if slower > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif slower < -args.threshold:
+            flag = "  faster"
+
+        print("%-*s  %12s  %12s  %+7.1f%%%s" % (width, name, cols[0], cols[1], change, flag))
+
+    only = sorted(set(base) ^ set(new))
+    if only:
+        print("\n%d benchmarks are only in one run" % len(only))
+
+    print("\n%d of %d benchmarks regressed by more than %.1f%%" % (regressions, len(names), args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,180 @@
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <string>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * How evenly std::hash and drt::hash spread a sample of keys over a
+ * table, and how fast they are. Usage:
+ *
+ *   hash_quality seq|stride<n>|random|strings <thousands> [<buckets>]
+ *   hash_quality <file> [<buckets>]
+ *
+ * A file holds one key per line, hashed as uint64_t if every line is a
+ * number and as std::string otherwise. The table has as many buckets as
+ * keys unless given, indexed both by modulo, as Hashmap does, and by the
+ * low bits of the hash over the next power of two.
+ *
+ * For each it prints chi-squared over the bucket counts divided by its
+ * degrees of freedom (about 1 for a random spread, far above for
+ * clustering), the longest chain and the share of empty buckets.
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+/// Bytes hashed for a key, for throughput.
+size_t key_bytes(uint64_t) { return 8; }
+size_t key_bytes(const std::string &s) { return s.size(); }
+
+struct Spread {
+    double chi2 = 0;        ///< chi-squared / (buckets - 1)
+    size_t longest = 0;
+    double empty = 0;       ///< share of buckets with no key
+};
+
+/// Tallies keys into buckets by bucket_of(hash).
+template<class Index>
+Spread spread(const std::vector<size_t> &hashes, size_t buckets, Index bucket_of) {
+    std::vector<uint32_t> counts(buckets);
+    for (size_t h : hashes) ++counts[bucket_of(h)];
+
+    Spread s;
+    double expected = static_cast<double>(hashes.size()) / buckets;
+    size_t empty = 0;
+
+    for (uint32_t c : counts) {
+        double d = c - expected;
+        s.chi2 += d * d / expected;
+        s.longest = std::max<size_t>(s.longest, c);
+        empty += c == 0;
+    }
+
+    s.chi2 /= std::max<size_t>(buckets - 1, 1);
+    s.empty = static_cast<double>(empty) / buckets;
+    return s;
+}
+
+template<class Hash, class K>
+void analyse(const std::vector<K> &keys, size_t buckets, std::string name) {
+    Hash hf;
+    std::vector<size_t> hashes;
+    hashes.reserve(keys.size());
+    for (const K &k : keys) hashes.push_back(hf(k));
+
+    Spread modulo = spread(hashes, buckets, [buckets](size_t h) { return h % buckets; });
+
+    size_t pow2 = 1;
+    while (pow2 < buckets) pow2 <<= 1;
+    Spread mask = spread(hashes, pow2, [pow2](size_t h) { return h & (pow2 - 1); });
+
+    // time enough passes for a few hundred ms, at least one
+    size_t bytes = 0;
+    for (const K &k : keys) bytes += key_bytes(k);
+    size_t passes = std::max<size_t>(1, 50000000 / keys.size());
+
+    volatile size_t sink = 0;
+    auto _start = clock_type::now();
+    for (size_t p = 0; p < passes; ++p) {
+        size_t x = 0;
+        for (const K &k : keys) x ^= hf(k);
+        sink = sink + x;
+    }
+    double ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count();
+    double per_key = ns / passes / keys.size();
+
+    printf("| %-10s | %% %-8lu chi2/df %10.3f max %5lu empty %5.1f%% | & %-8lu chi2/df %10.3f max %5lu empty %5.1f%% | %6.2f ns/key %7.2f GB/s |\n",
+           name.c_str(), buckets, modulo.chi2, modulo.longest, 100 * modulo.empty,
+           pow2, mask.chi2, mask.longest, 100 * mask.empty,
+           per_key, bytes * passes / ns);
+}
+
+template<class K>
+void analyse_all(const std::vector<K> &keys, size_t buckets, std::string sample) {
+    if (keys.empty()) {
+        std::cout << "No keys\n";
+        return;
+    }
+    if (!buckets) buckets = keys.size();
+
+    int i = printf("| Hash quality of %lu %s keys |\n", keys.size(), sample.c_str());
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    analyse<std::hash<K>>(keys, buckets, "std::hash");
+    analyse<drt::hash<K>>(keys, buckets, "drt::hash");
+}
+
+/// One key per line: numbers if every line is one, otherwise strings.
+void analyse_file(const char *path, size_t buckets) {
+    std::ifstream f(path);
+    std::vector<std::string> lines;
+    std::vector<uint64_t> numbers;
+    bool numeric = true;
+
+    for (std::string line; std::getline(f, line);) {
+        if (numeric) {
+            char *end = nullptr;
+            uint64_t v = std::strtoull(line.c_str(), &end, 10);
+            numeric = !line.empty() && *end == '\0';
+            numbers.push_back(v);
+        }
+        lines.push_back(line);
+    }
+
+    if (numeric) {
+        analyse_all(numbers, buckets, path);
+    } else {
+        analyse_all(lines, buckets, path);
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: hash_quality seq|stride<n>|random|strings <thousands> [<buckets>]\n"
+                  << "       hash_quality <file> [<buckets>]\n";
+        return 0;
+    }
+
+    std::string sample = argv[1];
+    bool generated = sample == "seq" || sample == "random" || sample == "strings" || sample.compare(0, 6, "stride") == 0;
+
+    if (!generated) {
+        analyse_file(argv[1], argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0);
+        return 0;
+    }
+
+    float factor = argc > 2 ? std::strtof(argv[2], nullptr) : 0;
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000 * factor);
+    size_t buckets = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+    if (sample == "strings") {
+        // the shape of many real keys: a shared prefix and a counter
+        std::vector<std::string> keys;
+        keys.reserve(n);
+        for (size_t i = 0; i < n; ++i) keys.push_back("user:" + std::to_string(i) + ":session");
+        analyse_all(keys, buckets, sample);
+        return 0;
+    }
+
+    std::vector<uint64_t> keys;
+    keys.reserve(n);
+    if (sample == "random") {
+        drt_testing::fill_vector(keys);
+    } else {
+        uint64_t stride = sample == "seq" ? 1 : std::max(1ul, std::strtoul(sample.c_str() + 6, nullptr, 10));
+        for (size_t i = 0; i < n; ++i) keys.push_back(i * stride);
+    }
+    analyse_all(keys, buckets, sample);
+
+    return 0;
+}
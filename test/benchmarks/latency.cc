@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Per-operation latency percentiles of insert, search and erase on a
+ * map of uint64_t, for each of the given sizes. Usage:
+ *
+ *   latency default|grouped|geometric|std <thousands> [<thousands> ...]
+ *
+ * Set LATENCY_BATCH to time groups of operations instead of single ones.
+ */
+
+using _t = uint64_t;
+
+struct GeometricPolicy : drt::MapPolicy {
+    using pool_size = drt::geometric_pool_size<>;
+};
+
+template<class HMap>
+void latency_test(size_t n, std::string name, size_t batch) {
+    HMap h;
+    drt_testing::run_latency_test<_t>(h, n, name, batch);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cout << "Usage: latency default|grouped|geometric|std <thousands> [<thousands> ...]\n";
+        return 0;
+    }
+
+    const char *env = std::getenv("LATENCY_BATCH");
+    size_t batch = env ? std::max(1ul, std::strtoul(env, nullptr, 10)) : 1;
+
+    for (int i = 2; i < argc; ++i) {
+        float factor = std::strtof(argv[i], nullptr);
+        if (factor <= 0.0) {
+            std::cout << "USE A POSITIVE NUMBER!!!\n";
+            return 0;
+        }
+
+        size_t n = (size_t) (1000 * factor);
+
+        if (std::strcmp(argv[1], "std") == 0) {
+            latency_test<std::unordered_map<_t, _t>>(n, "std::unordered_map", batch);
+        } else if (std::strcmp(argv[1], "grouped") == 0) {
+            latency_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::GroupedPolicy>>(n, "drt::Hashmap<Grouped>", batch);
+        } else if (std::strcmp(argv[1], "geometric") == 0) {
+            latency_test<drt::Hashmap<_t, _t, std::hash<_t>, GeometricPolicy>>(n, "drt::Hashmap<Geometric>", batch);
+        } else {
+            latency_test<drt::Hashmap<_t, _t>>(n, "drt::Hashmap", batch);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "alloc_counter.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Memory held while the bucket array grows: a flat array, rebuilt into a
+ * second array on each growth, against LinearPolicy's segmented directory,
+ * which splits one bucket per insert. Usage:
+ *
+ *   linear_growth flat|linear <millions>
+ *
+ * One map per run, as freed pages stay resident and would hide a second
+ * map's RSS. It reports the peak and final heap bytes and the peak RSS
+ * above the RSS before filling, the slowest single insert (the pause of
+ * the last full rehash, for the flat array), and the mean time per
+ * insert and per hit.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+template<class Policy>
+void growth_run(const std::vector<_t> &keys, const char *label) {
+    using HMap = drt::Hashmap<_t, _t, std::hash<_t>, Policy>;
+
+    uint64_t base = drt_testing::heap_counters.live;
+    drt_testing::heap_counters.reset_peak();
+    uint64_t rss = drt_testing::current_rss();
+    drt_testing::reset_peak_rss();
+
+    HMap *h = new HMap();
+    double slowest = 0;
+
+    auto _start = clock_type::now();
+    for (const _t &k : keys) {
+        auto t = clock_type::now();
+        (*h)[k] = k;
+        double ns = std::chrono::duration<double, std::nano>(clock_type::now() - t).count();
+        if (ns > slowest) slowest = ns;
+    }
+    double insert_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+
+    uint64_t peak = drt_testing::heap_counters.peak - base;
+    uint64_t held = drt_testing::heap_counters.live - base;
+    uint64_t peak_rss = drt_testing::peak_rss();
+
+    size_t found = 0;
+    _start = clock_type::now();
+    for (const _t &k : keys) found += h->count(k);
+    double hit_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+    drt_testing::search_sink = found;
+
+    printf("| %-14s | heap peak %8.2f MB | final %8.2f MB | rss peak +%8.2f MB | buckets %9lu | slowest insert %9.3f ms | insert %7.2f ns | hit %7.2f ns |\n",
+           label, peak / 1048576.0, held / 1048576.0, (peak_rss > rss ? peak_rss - rss : 0) / 1048576.0,
+           h->bucket_count(), slowest / 1e6, insert_ns, hit_ns);
+
+    delete h;
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cout << "Usage: linear_growth flat|linear <millions>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[2], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000000 * factor);
+
+    std::vector<_t> keys;
+    keys.reserve(n);
+    drt_testing::fill_vector(keys);
+
+    int i = printf("| Bucket array growth [%lu] with drt::Hashmap |\n", n);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    if (std::strcmp(argv[1], "linear") == 0) {
+        growth_run<drt::LinearPolicy>(keys, "LinearPolicy");
+    } else {
+        growth_run<drt::ChainedPolicy>(keys, "ChainedPolicy");
+    }
+
+    return 0;
+}
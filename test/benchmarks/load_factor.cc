@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Memory against time for maximum load factors from 0.5 to 4, and for
+ * the growth policies. Usage:
+ *
+ *   load_factor default|grouped|inline <thousands>
+ *
+ * Each row fills a fresh map with random keys, then reports the bytes
+ * per entry held by the map (Hashmap::memory_usage), the load factor it
+ * ended at, the mean probes per hit, and the time per insert, hit and
+ * miss. Bytes and load depend on where n falls between two growths, so
+ * compare several sizes before choosing.
+ */
+
+using clock_type = std::chrono::steady_clock;
+
+template<class Base, class Growth>
+struct With : Base {
+    using growth = Growth;
+};
+
+double ns_per(clock_type::time_point start, size_t n) {
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / n;
+}
+
+template<class HMap, typename T>
+void curve_point(const std::vector<T> &hits, const std::vector<T> &misses, float lf, std::string name) {
+    HMap h;
+    if (lf > 0) h.max_load_factor(lf);
+
+    auto _start = clock_type::now();
+    for (const T &k : hits) h[k] = 42;
+    double insert_ns = ns_per(_start, hits.size());
+
+    size_t probes = 0;
+    for (size_t i = 0; i < hits.size(); i += 16) probes += h.probe_count(hits[i]);
+
+    size_t found = 0;
+    _start = clock_type::now();
+    for (const T &k : hits) found += h.count(k);
+    double hit_ns = ns_per(_start, hits.size());
+
+    _start = clock_type::now();
+    for (const T &k : misses) found += h.count(k);
+    double miss_ns = ns_per(_start, misses.size());
+    drt_testing::search_sink = found;
+
+    printf("| %-24s | max lf %5.2f | lf %5.2f | %7.2f B/entry | %5.3f probes | insert %7.2f ns | hit %6.2f ns | miss %6.2f ns |\n",
+           name.c_str(), h.max_load_factor(), h.load_factor(), h.memory_usage().bytes_per_element(),
+           static_cast<double>(probes) / ((hits.size() + 15) / 16), insert_ns, hit_ns, miss_ns);
+}
+
+template<typename T, class Base>
+void curves(size_t n, std::string name) {
+    std::vector<T> v;
+    v.reserve(2 * n);
+    drt_testing::fill_vector(v);
+
+    std::vector<T> hits(v.begin(), v.begin() + n);
+    std::vector<T> misses(v.begin() + n, v.end());
+
+    int i = printf("| Load factor curve [%lu] with %s |\n", n, name.c_str());
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    const float factors[] = {0.5f, 0.75f, 1, 1.5f, 2, 3, 4};
+    for (float lf : factors) {
+        curve_point<drt::Hashmap<T, T, std::hash<T>, Base>>(hits, misses, lf, "doubling_growth");
+    }
+
+    curve_point<drt::Hashmap<T, T, std::hash<T>, With<Base, drt::growth_factor<3, 2>>>>(hits, misses, 0, "growth_factor<3, 2>");
+    curve_point<drt::Hashmap<T, T, std::hash<T>, With<Base, drt::prime_growth<>>>>(hits, misses, 0, "prime_growth<>");
+    curve_point<drt::Hashmap<T, T, std::hash<T>, With<Base, drt::dense_growth<>>>>(hits, misses, 0, "dense_growth<300>");
+    curve_point<drt::Hashmap<T, T, std::hash<T>, With<Base, drt::model_growth<>>>>(hits, misses, 0, "model_growth<150>");
+    curve_point<drt::Hashmap<T, T, std::hash<T>, With<Base, drt::model_growth<250>>>>(hits, misses, 0, "model_growth<250>");
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cout << "Usage: load_factor default|grouped|inline <thousands>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[2], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000 * factor);
+
+    if (std::strcmp(argv[1], "grouped") == 0) {
+        curves<uint64_t, drt::GroupedPolicy>(n, "drt::GroupedPolicy, uint64_t");
+    } else if (std::strcmp(argv[1], "inline") == 0) {
+        curves<uint32_t, drt::InlinePolicy>(n, "drt::InlinePolicy, uint32_t");
+    } else {
+        curves<uint64_t, drt::MapPolicy>(n, "drt::MapPolicy, uint64_t");
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Fills and searches a Hashmap<uint64_t, uint64_t> with and without
+ * collect_stats, to measure what the counters cost, then prints the
+ * statistics the counting map gathered. Usage:
+ *
+ *   map_stats <thousands> [chained|grouped]
+ */
+
+using _t = uint64_t;
+
+template<class Bucket>
+struct Counting : Bucket {
+    using stats = drt::collect_stats;
+};
+
+template<class HMap>
+void stats_test(std::vector<_t> &keys, std::vector<_t> &misses, std::string name, bool dump) {
+    using clock_type = std::chrono::steady_clock;
+
+    HMap m;
+    auto _start = clock_type::now();
+    for (_t k : keys) m[k] = k;
+    double fill_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+
+    _start = clock_type::now();
+    size_t found = 0;
+    for (_t k : keys) found += m.count(k);
+    for (_t k : misses) found += m.count(k);
+    drt_testing::search_sink = found;
+    double search_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+
+    printf("| %-16s [%lu] | fill %9.2f ms | search %9.2f ms |\n", name.c_str(), keys.size(), fill_ms, search_ms);
+    if (dump) std::cout << m.statistics().to_text();
+}
+
+template<class Policy>
+void run(std::vector<_t> &keys, std::vector<_t> &misses, std::string name) {
+    stats_test<drt::Hashmap<_t, _t, std::hash<_t>, Policy>>(keys, misses, name, false);
+    stats_test<drt::Hashmap<_t, _t, std::hash<_t>, Counting<Policy>>>(keys, misses, name + "+stats", true);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: map_stats <thousands> [chained|grouped]\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+
+    size_t n = (size_t) (1000 * factor);
+
+    // the second half of the random keys is never inserted
+    std::vector<_t> all;
+    all.reserve(2 * n);
+    drt_testing::fill_vector(all);
+    std::vector<_t> keys(all.begin(), all.begin() + n);
+    std::vector<_t> misses(all.begin() + n, all.end());
+
+    if (argc > 2 && std::strcmp(argv[2], "grouped") == 0) {
+        run<drt::GroupedPolicy>(keys, misses, "grouped");
+    } else {
+        run<drt::ChainedPolicy>(keys, misses, "chained");
+    }
+
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "dirtyMap/HashMap.hpp"
+
+#if SUITE_BOOST
+#include <boost/unordered_map.hpp>
+#endif
+#if SUITE_SPARSE
+#include <sparsehash/sparse_hash_map>
+#endif
+
+/*
+ * Every map and workload in one Google Benchmark binary, instead of one
+ * build per map. Each benchmark is named
+ *
+ *   <workload>/<map>/<key>:<value>/<elements>
+ *
+ * so a subset can be picked with --benchmark_filter, e.g.
+ * --benchmark_filter='search_hit/.*u64'. Machine readable results:
+ *
+ *   map_suite --benchmark_out=run.json --benchmark_out_format=json
+ *
+ * and compare two runs with compare_benchmarks.py. boost::unordered_map
+ * and google::sparse_hash_map are included when CMake finds them.
+ */
+
+namespace {
+
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~~ keys and values ~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    template<typename T>
+    struct type_info;
+
+    template<>
+    struct type_info<uint32_t> {
+        static const char* name() { return "u32"; }
+        static uint32_t make(uint64_t r) { return static_cast<uint32_t>(r); }
+    };
+
+    template<>
+    struct type_info<uint64_t> {
+        static const char* name() { return "u64"; }
+        static uint64_t make(uint64_t r) { return r; }
+    };
+
+    /// 16 to 24 characters, past the small string buffer.
+    template<>
+    struct type_info<std::string> {
+        static const char* name() { return "str"; }
+        static std::string make(uint64_t r) { return "key:" + std::to_string(r) + ":dirty"; }
+    };
+
+    /// n distinct keys, the same for every map.
+    template<typename K>
+    std::vector<K> make_keys(size_t n, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> raw;
+        raw.reserve(n + n / 8);
+
+        while (raw.size() < n) {
+            while (raw.size() < n + n / 8) {
+                uint64_t r = rng();
+                if (static_cast<uint32_t>(r) != ~uint32_t(0)) raw.push_back(r);
+            }
+            std::sort(raw.begin(), raw.end());
+            raw.erase(std::unique(raw.begin(), raw.end()), raw.end());
+        }
+        std::shuffle(raw.begin(), raw.end(), rng);
+
+        std::vector<K> keys;
+        keys.reserve(n);
+        for (size_t i = 0; i < n; ++i) keys.push_back(type_info<K>::make(raw[i]));
+        return keys;
+    }
+
+    /// Keys in the map, and as many that are not.
+    template<typename K>
+    struct key_sets {
+        std::vector<K> hits;
+        std::vector<K> misses;
+
+        explicit key_sets(size_t n) {
+            std::vector<K> all = make_keys<K>(2 * n, 314159);
+            hits.assign(all.begin(), all.begin() + n);
+            misses.assign(all.begin() + n, all.end());
+        }
+    };
+
+    /// Per-map setup before use; sparse_hash_map needs a key to mark erasures.
+    template<class Map>
+    void prepare(Map &) { }
+
+#if SUITE_SPARSE
+    template<typename K, typename V>
+    void prepare(google::sparse_hash_map<K, V> &m) {
+        // make_keys() skips raw values whose low 32 bits are all set
+        m.set_deleted_key(type_info<K>::make(~uint64_t(0)));
+    }
+#endif
+
+    template<class Map, typename K>
+    void fill(Map &m, const std::vector<K> &keys) {
+        prepare(m);
+        typename Map::mapped_type v = typename Map::mapped_type();
+        for (const K &k : keys) m[k] = v;
+    }
+
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ workloads ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    template<class Map>
+    void insert(benchmark::State &state) {
+        using K = typename Map::key_type;
+        key_sets<K> keys(state.range(0));
+
+        for (auto _ : state) {
+            Map m;
+            fill(m, keys.hits);
+            benchmark::DoNotOptimize(m.size());
+
+            state.PauseTiming();
+            m = Map();  // the destructor isn't part of insertion
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<class Map, bool hit>
+    void search(benchmark::State &state) {
+        using K = typename Map::key_type;
+        key_sets<K> keys(state.range(0));
+        Map m;
+        fill(m, keys.hits);
+
+        const std::vector<K> &look = hit ? keys.hits : keys.misses;
+
+        for (auto _ : state) {
+            size_t found = 0;
+            for (const K &k : look) found += m.count(k);
+            benchmark::DoNotOptimize(found);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<class Map>
+    void erase(benchmark::State &state) {
+        using K = typename Map::key_type;
+        key_sets<K> keys(state.range(0));
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            Map m;
+            fill(m, keys.hits);
+            state.ResumeTiming();
+
+            for (const K &k : keys.hits) m.erase(k);
+            benchmark::DoNotOptimize(m.size());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<class Map>
+    void iterate(benchmark::State &state) {
+        using K = typename Map::key_type;
+        key_sets<K> keys(state.range(0));
+        Map m;
+        fill(m, keys.hits);
+
+        for (auto _ : state) {
+            size_t n = 0;
+            for (auto it = m.begin(); it != m.end(); ++it) {
+                benchmark::DoNotOptimize(&*it);
+                ++n;
+            }
+            benchmark::DoNotOptimize(n);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    /**
+     * Of every 10 operations, 8 lookups (half hits), one insert of a new
+     * key and one erase of a key inserted earlier in the same pass, so the
+     * map is back to its starting contents after each iteration.
+     */
+    template<class Map>
+    void mixed(benchmark::State &state) {
+        using K = typename Map::key_type;
+        size_t n = state.range(0);
+        key_sets<K> keys(n);
+        Map m;
+        fill(m, keys.hits);
+
+        // fresh keys come from the misses, so lookups of them may hit
+        size_t fresh = std::max<size_t>(n / 10, 1);
+        typename Map::mapped_type v = typename Map::mapped_type();
+
+        for (auto _ : state) {
+            size_t found = 0;
+
+            for (size_t i = 0; i < 10 * fresh; ++i) {
+                switch (i % 10) {
+                    case 0:
+                        m[keys.misses[i / 10]] = v;
+                        break;
+                    case 5:
+                        m.erase(keys.misses[i / 10]);
+                        break;
+                    default:
+                        found += m.count(i & 1 ? keys.hits[i % n] : keys.misses[i % n]);
+                }
+            }
+            benchmark::DoNotOptimize(found);
+        }
+        state.SetItemsProcessed(state.iterations() * 10 * fresh);
+    }
+
+    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ registration ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+    std::vector<int64_t> sizes = {1 << 10, 1 << 16, 1 << 20};
+
+    template<class Map>
+    void register_map(const std::string &map_name) {
+        using K = typename Map::key_type;
+        using V = typename Map::mapped_type;
+        std::string suffix = "/" + map_name + "/" + type_info<K>::name() + ":" + type_info<V>::name();
+
+        struct workload {
+            const char *name;
+            void (*fn)(benchmark::State&);
+        };
+
+        const workload workloads[] = {
+            {"insert",      insert<Map>},
+            {"search_hit",  search<Map, true>},
+            {"search_miss", search<Map, false>},
+            {"erase",       erase<Map>},
+            {"iterate",     iterate<Map>},
+            {"mixed",       mixed<Map>},
+        };
+
+        for (const workload &w : workloads) {
+            benchmark::internal::Benchmark *b = benchmark::RegisterBenchmark((w.name + suffix).c_str(), w.fn);
+            for (int64_t n : sizes) b->Arg(n);
+            b->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    template<typename K, typename V>
+    void register_maps() {
+        register_map<drt::Hashmap<K, V>>("drt::Hashmap");
+        register_map<drt::Hashmap<K, V, std::hash<K>, drt::GroupedPolicy>>("drt::Hashmap<Grouped>");
+        register_map<drt::Hashmap<K, V, drt::hash<K>>>("drt::Hashmap<drt::hash>");
+        register_map<std::unordered_map<K, V>>("std::unordered_map");
+#if SUITE_BOOST
+        register_map<boost::unordered_map<K, V>>("boost::unordered_map");
+#endif
+#if SUITE_SPARSE
+        register_map<google::sparse_hash_map<K, V>>("google::sparse_hash_map");
+#endif
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    // --suite_sizes=1024,1048576 replaces the default element counts
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 14, "--suite_sizes=") != 0) continue;
+
+        sizes.clear();
+        for (size_t pos = 14; pos < arg.size();) {
+            size_t comma = arg.find(',', pos);
+            if (comma == std::string::npos) comma = arg.size();
+            sizes.push_back(std::stoll(arg.substr(pos, comma - pos)));
+            pos = comma + 1;
+        }
+
+        std::copy(argv + i + 1, argv + argc, argv + i);
+        --argc;
+        break;
+    }
+
+    register_maps<uint64_t, uint64_t>();
+    register_maps<uint32_t, uint32_t>();
+    register_maps<std::string, uint64_t>();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Fills a Hashmap<uint64_t, uint64_t>, erases half of it and fills it
+ * again, with and without trace_ring, to measure what tracing costs. The
+ * traced map's events are written in Chrome trace format, for
+ * chrome://tracing or https://ui.perfetto.dev. Usage:
+ *
+ *   map_trace <thousands> [trace.json]
+ */
+
+using _t = uint64_t;
+
+struct Traced : drt::ChainedPolicy {
+    using trace = drt::trace_ring<1 << 16>;
+};
+
+template<class HMap>
+void trace_test(std::vector<_t> &keys, std::string name, const char *out) {
+    using clock_type = std::chrono::steady_clock;
+
+    HMap m;
+    auto _start = clock_type::now();
+
+    for (size_t i = 0; i < keys.size() / 2; ++i) m[keys[i]] = i;
+    for (size_t i = 0; i < keys.size() / 2; i += 2) m.erase(keys[i]);
+    for (size_t i = keys.size() / 2; i < keys.size(); ++i) m[keys[i]] = i;
+
+    double ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+    drt::TraceLog log = m.trace_log();
+
+    printf("| %-7s [%lu] | %9.2f ms | %8lu events | %8lu dropped |\n",
+           name.c_str(), keys.size(), ms, log.events.size(), log.dropped);
+
+    if (out) std::ofstream(out) << log.to_chrome_trace();
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: map_trace <thousands> [trace.json]\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+
+    std::vector<_t> keys;
+    keys.reserve((size_t) (1000 * factor));
+    drt_testing::fill_vector(keys);
+
+    trace_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::ChainedPolicy>>(keys, "plain", nullptr);
+    trace_test<drt::Hashmap<_t, _t, std::hash<_t>, Traced>>(keys, "traced", argc > 2 ? argv[2] : nullptr);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Fills a Hashmap<uint32_t, uint32_t> and prints where its memory goes, as
+ * reported by memory_usage(), next to what malloc actually handed out for
+ * it. Usage:
+ *
+ *   memory_breakdown <thousands> chained|inline|grouped|geometric
+ */
+
+using _t = uint32_t;
+
+struct GeometricPolicy : drt::ChainedPolicy {
+    using pool_size = drt::geometric_pool_size<>;
+};
+
+void print_pools(const char* name, const drt::AllocatorUsage &u) {
+    float lo = 1, hi = 0;
+    for (float f : u.fill) {
+        lo = std::min(lo, f);
+        hi = std::max(hi, f);
+    }
+    if (u.fill.empty()) lo = 0;
+
+    printf("  %-8s %6lu pools | %12lu objects | used %10.2f MB | reserved %10.2f MB | fill %5.1f%% (%5.1f%% .. %5.1f%%)\n",
+           name, u.pools, u.objects, u.used_bytes / 1048576.0, u.reserved_bytes / 1048576.0,
+           100 * u.fill_ratio(), 100 * lo, 100 * hi);
+}
+
+template<class HMap>
+void breakdown_test(size_t n, std::string name) {
+    std::vector<_t> keys;
+    keys.reserve(n);
+    drt_testing::fill_vector(keys);
+
+    uint64_t before = drt_testing::current_heap_use();
+    HMap *m = new HMap();
+    for (_t k : keys) (*m)[k] = k;
+    uint64_t after = drt_testing::current_heap_use();
+
+    drt::MemoryUsage u = m->memory_usage();
+    printf("| %-9s [%lu] | %8.2f bytes/element | total %10.2f MB | malloc %10.2f MB |\n",
+           name.c_str(), n, u.bytes_per_element(), u.total_bytes() / 1048576.0, (after - before) / 1048576.0);
+    printf("  buckets  %6lu buckets | %10.2f MB | load factor %.2f\n",
+           m->bucket_count(), u.bucket_bytes / 1048576.0, m->load_factor());
+    print_pools("elements", u.element_pools);
+    print_pools("nodes", u.node_pools);
+
+    delete m;
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cout << "Usage: memory_breakdown <thousands> chained|inline|grouped|geometric\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+
+    size_t n = (size_t) (1000 * factor);
+
+    if (std::strcmp(argv[2], "inline") == 0) {
+        breakdown_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::InlinePolicy>>(n, "inline");
+    } else if (std::strcmp(argv[2], "grouped") == 0) {
+        breakdown_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::GroupedPolicy>>(n, "grouped");
+    } else if (std::strcmp(argv[2], "geometric") == 0) {
+        breakdown_test<drt::Hashmap<_t, _t, std::hash<_t>, GeometricPolicy>>(n, "geometric");
+    } else {
+        breakdown_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::ChainedPolicy>>(n, "chained");
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "alloc_counter.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Hashmap::set_memory_budget: memory against speed when the budget stops
+ * the bucket array from growing. Usage:
+ *
+ *   memory_budget <millions>
+ *
+ * First fills a map with no budget. Then it fills maps whose budget is a
+ * share of the first map's final size. For each map it reports the peak
+ * and final heap bytes, the load factor reached, whether the map is over
+ * budget, and the time per insert and per hit.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+template<class HMap>
+uint64_t budget_run(const std::vector<_t> &keys, uint64_t budget, const char *label) {
+    uint64_t base = drt_testing::heap_counters.live;
+    drt_testing::heap_counters.reset_peak();
+
+    HMap *h = new HMap();
+    h->set_memory_budget(budget);
+
+    auto _start = clock_type::now();
+    for (const _t &k : keys) (*h)[k] = k;
+    double insert_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+
+    uint64_t peak = drt_testing::heap_counters.peak - base;
+    uint64_t held = drt_testing::heap_counters.live - base;
+
+    size_t found = 0;
+    _start = clock_type::now();
+    for (const _t &k : keys) found += h->count(k);
+    double hit_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+    drt_testing::search_sink = found;
+
+    printf("| %-9s | budget %8.2f MB | peak %8.2f MB | final %8.2f MB | lf %5.2f%s | insert %7.2f ns | hit %7.2f ns |\n",
+           label, budget / 1048576.0, peak / 1048576.0, held / 1048576.0, h->load_factor(),
+           h->over_budget() ? " (over budget)" : "               ", insert_ns, hit_ns);
+
+    delete h;
+    return held;
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: memory_budget <millions>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000000 * factor);
+
+    std::vector<_t> keys;
+    keys.reserve(n);
+    drt_testing::fill_vector(keys);
+
+    using map_type = drt::Hashmap<_t, _t>;
+
+    int i = printf("| Memory budget [%lu] with drt::Hashmap |\n", n);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    uint64_t full = budget_run<map_type>(keys, 0, "no budget");
+
+    const unsigned shares[] = {100, 90, 80, 70};
+    for (unsigned share : shares) {
+        std::string label = std::to_string(share) + "%";
+        budget_run<map_type>(keys, full / 100 * share, label.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <array>
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Chain walks with large mapped values. A node keeps its link before the
+ * element, so each step of a lookup reads the link and the key from one
+ * cache line, rather than a key line and then a link line past the value.
+ * Usage:
+ *
+ *   node_layout <millions>
+ *
+ * Keys are 8 bytes; values 8, 64 and 256. Each size runs at the default
+ * load factor and at 4, where chains are long. It reports the probes per
+ * miss, the bytes per entry and the time per hit and per miss.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+template<size_t Bytes>
+using payload = std::array<char, Bytes>;
+
+template<size_t Bytes>
+void layout_run(const std::vector<_t> &keys, const std::vector<_t> &misses, float load) {
+    drt::Hashmap<_t, payload<Bytes>> h;
+    h.max_load_factor(load);
+
+    for (const _t &k : keys) h[k].fill(1);
+
+    size_t probes = 0;
+    for (const _t &k : misses) probes += h.probe_count(k);
+
+    size_t found = 0;
+    auto _start = clock_type::now();
+    for (const _t &k : keys) found += h.count(k);
+    double hit_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+
+    _start = clock_type::now();
+    for (const _t &k : misses) found += h.count(k);
+    double miss_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / misses.size();
+    drt_testing::search_sink = found;
+
+    printf("| %3lu B values | lf %4.2f | %5.2f probes/miss | %7.2f B/entry | hit %7.2f ns | miss %7.2f ns |\n",
+           Bytes, h.load_factor(), (double) probes / misses.size(),
+           h.memory_usage().bytes_per_element(), hit_ns, miss_ns);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: node_layout <millions>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000000 * factor);
+
+    // the first n keys are stored, the rest are looked up as misses
+    std::vector<_t> keys;
+    keys.reserve(2 * n);
+    drt_testing::fill_vector(keys);
+    std::vector<_t> misses(keys.begin() + n, keys.end());
+    keys.resize(n);
+
+    int i = printf("| Node layout [%lu] with drt::Hashmap, 8 byte keys |\n", n);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    const float loads[] = {1.0, 4.0};
+    for (float load : loads) {
+        layout_run<8>(keys, misses, load);
+        layout_run<64>(keys, misses, load);
+        layout_run<256>(keys, misses, load);
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Hashmap::optimize_layout: lookups and full iteration before and after
+ * the pools are rewritten in bucket order. Usage:
+ *
+ *   optimize_layout <millions>
+ *
+ * Each map is filled with random keys, then churned: half as many keys
+ * again are erased and replaced by new ones, scattering the pools. It
+ * reports the time per hit and per iterated entry before and after
+ * optimize_layout(), and how long that call took.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+template<class HMap>
+void measure(HMap &h, const std::vector<_t> &keys, const char *label, const char *when) {
+    size_t found = 0;
+    auto _start = clock_type::now();
+    for (const _t &k : keys) found += h.count(k);
+    double hit_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+
+    _t sum = 0;
+    _start = clock_type::now();
+    for (auto it = h.begin(); it != h.end(); ++it) sum += it->second;
+    double iter_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / h.size();
+    drt_testing::search_sink = found + sum;
+
+    printf("| %-13s | %-6s | hit %7.2f ns | iterate %6.2f ns/entry |", label, when, hit_ns, iter_ns);
+}
+
+template<class Policy>
+void layout_run(const std::vector<_t> &fill, const std::vector<_t> &churn, const char *label) {
+    drt::Hashmap<_t, _t, std::hash<_t>, Policy> h;
+
+    for (const _t &k : fill) h[k] = k;
+    for (size_t i = 0; i < churn.size(); ++i) {
+        h.erase(fill[2 * i]);
+        h[churn[i]] = churn[i];
+    }
+
+    // the keys now stored, in random order
+    std::vector<_t> keys;
+    keys.reserve(h.size());
+    for (size_t i = 0; i < fill.size(); ++i) {
+        if (i % 2 || i >= 2 * churn.size()) keys.push_back(fill[i]);
+    }
+    keys.insert(keys.end(), churn.begin(), churn.end());
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(1));
+
+    measure(h, keys, label, "before");
+    printf("\n");
+
+    auto _start = clock_type::now();
+    h.optimize_layout();
+    double ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+
+    measure(h, keys, label, "after");
+    printf(" optimize_layout %8.2f ms |\n", ms);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: optimize_layout <millions>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000000 * factor);
+
+    std::vector<_t> keys;
+    keys.reserve(n + n / 2);
+    drt_testing::fill_vector(keys);
+    std::vector<_t> churn(keys.begin() + n, keys.end());
+    keys.resize(n);
+
+    int i = printf("| Pool layout [%lu] with drt::Hashmap |\n", n);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    layout_run<drt::MapPolicy>(keys, churn, "MapPolicy");
+    layout_run<drt::ChainedPolicy>(keys, churn, "ChainedPolicy");
+    layout_run<drt::StablePolicy>(keys, churn, "StablePolicy");
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Memory and time for Hashmap<uint32_t, uint32_t> (chained buckets) with
+ * different pool sizing policies. Memory is what malloc handed out for the
+ * map, including the first pools. Run each policy in its own process:
+ *
+ *   pool_sizing <thousands> fixed|geometric|2mb|32mb
+ */
+
+struct GeometricPools : drt::ChainedPolicy {
+    using pool_size = drt::geometric_pool_size<>;
+};
+
+struct Pools2MB : drt::ChainedPolicy {
+    using pool_size = drt::pool_bytes<2 << 20>;
+};
+
+struct Pools32MB : drt::ChainedPolicy {
+    using pool_size = drt::pool_bytes<32 << 20>;
+};
+
+template<class Policy>
+void sizing_test(size_t num, std::string name) {
+    using _t = uint32_t;
+    using HMap = drt::Hashmap<_t, _t, std::hash<_t>, Policy>;
+    using clock_type = std::chrono::steady_clock;
+
+    std::vector<_t> v;
+    v.reserve(num);
+    drt_testing::fill_vector<_t>(v);
+
+    uint64_t before = drt_testing::current_heap_use();
+    HMap h;
+    auto _start = clock_type::now();
+    drt_testing::fill_map<_t, HMap>(v, h);
+    double insert_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+    uint64_t after = drt_testing::current_heap_use();
+
+    drt_testing::shuffle_vector<_t>(v);
+    _start = clock_type::now();
+    drt_testing::search_map<_t, HMap>(v, h);
+    double search_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+
+    printf("| %-10s [%lu] | %9.2f MB | %8.2f bytes/entry | insert %9.2f ms | search %9.2f ms |\n",
+           name.c_str(), num, (double) (after - before) / (1 << 20),
+           (double) (after - before) / h.size(), insert_ms, search_ms);
+}
+
+int main(int argc, char* argv[]) {
+
+    size_t thousands = 0;
+
+    if (argc > 2) {
+        float factor = std::strtof(argv[1], nullptr);
+        if (factor <= 0.0) {
+            std::cout << "USE A POSITIVE NUMBER!!!\n";
+            return 0;
+        }
+        thousands = (size_t) (1000 * factor);
+    } else {
+        std::cout << "Usage: pool_sizing <thousands> fixed|geometric|2mb|32mb\n";
+        return 0;
+    }
+
+    if (std::strcmp(argv[2], "geometric") == 0) {
+        sizing_test<GeometricPools>(thousands, "geometric");
+    } else if (std::strcmp(argv[2], "2mb") == 0) {
+        sizing_test<Pools2MB>(thousands, "2mb");
+    } else if (std::strcmp(argv[2], "32mb") == 0) {
+        sizing_test<Pools32MB>(thousands, "32mb");
+    } else {
+        sizing_test<drt::ChainedPolicy>(thousands, "fixed");
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Compares bucket layouts by the number of stored entries each lookup
+ * dereferences (Hashmap::probe_count), for hits and for misses, along with
+ * the time taken by the same lookups.
+ */
+
+template<class T, class HMap>
+void probe_test(HMap &h, size_t num, std::string name) {
+    std::vector<T> v;
+    v.reserve(num * 2);
+    drt_testing::fill_vector<T>(v);
+
+    // first half is inserted, second half only used for misses
+    std::vector<T> hits(v.begin(), v.begin() + num);
+    std::vector<T> misses(v.begin() + num, v.end());
+    drt_testing::fill_map<T, HMap>(hits, h);
+    drt_testing::shuffle_vector<T>(hits);
+
+    size_t hit_probes = 0, miss_probes = 0;
+    for (T k : hits) hit_probes += h.probe_count(k);
+    for (T k : misses) miss_probes += h.probe_count(k);
+
+    auto _start = std::chrono::steady_clock::now();
+    drt_testing::search_map<T, HMap>(hits, h);
+    double hit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+
+    _start = std::chrono::steady_clock::now();
+    drt_testing::search_map<T, HMap>(misses, h);
+    double miss_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+
+    printf("| %-22s [%lu] lf %.2f | hit: %.3f probes %8.2f ms | miss: %.3f probes %8.2f ms |\n",
+           name.c_str(), num, h.load_factor(),
+           (double) hit_probes / num, hit_ms,
+           (double) miss_probes / num, miss_ms);
+}
+
+int main(int argc, char* argv[]) {
+
+    size_t millions = 0;
+
+    if (argc > 1) {
+        float factor = std::strtof(argv[1], nullptr);
+        if (factor <= 0.0) {
+            std::cout << "USE A POSITIVE NUMBER!!!\n";
+            return 0;
+        }
+        millions = (size_t) (1000000 * factor);
+    } else {
+        std::cout << "No arguments\n";
+        return 0;
+    }
+
+    using _t = uint64_t;
+
+    {
+        drt::Hashmap<_t, _t, std::hash<_t>> h;
+        probe_test<_t>(h, millions, "chained");
+    }
+    {
+        drt::Hashmap<_t, _t, std::hash<_t>, drt::GroupedPolicy> h;
+        probe_test<_t>(h, millions, "grouped");
+    }
+    {
+        drt::Hashmap<_t, _t, std::hash<_t>, drt::TaggedPolicy> h;
+        probe_test<_t>(h, millions, "tagged");
+    }
+
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <functional>
 
 #include "benchmark_utils.hpp"
+#include "alloc_counter.hpp"
 
 #define MAP_DEFINED 1
 #if STD
@@ -12,6 +13,10 @@
     #include <boost/unordered_map.hpp>
 #elif GOOGLE
     #include <google/sparse_hash_map>
+#elif FLAT
+    #include "dirtyMap/FlatMap.hpp"
+#elif TAGGED
+    #include "dirtyMap/HashMap.hpp"
 #elif FYP
     #include "dirtyMap/HashMap.hpp"
 #endif
@@ -46,6 +51,14 @@ int main(int argc, char* argv[]) {
     std::string map_name = "google::sparse_hash_map";
     using map_type = google::sparse_hash_map<_t, _t>;
     map_type h;
+#elif FLAT
+    std::string map_name = "drt::FlatDirtyMap";
+    using map_type = drt::FlatDirtyMap<_t, _t, std::hash<_t>>;
+    map_type h;
+#elif TAGGED
+    std::string map_name = "drt::Hashmap (TaggedPolicy)";
+    using map_type = drt::Hashmap<_t, _t, std::hash<_t>, drt::TaggedPolicy>;
+    map_type h;
 #elif FYP
     std::string map_name = "drt::Hashmap";
     using map_type = drt::Hashmap<_t, _t, std::hash<_t>>;
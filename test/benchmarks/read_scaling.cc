@@ -0,0 +1,190 @@
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Concurrent reads of a map built once: 1, 2, 4... threads call count()
+ * or at() at the same time, either all over the same keys (shared) or
+ * each over its own slice of them (disjoint). Usage:
+ *
+ *   read_scaling default|grouped|std <thousands> [<max threads>]
+ *
+ * Every thread does the same number of lookups, so with reads that
+ * really are read-only the per-thread rate should stay flat as threads
+ * are added, up to the number of cores. A rate that falls with more
+ * threads, worse in shared than in disjoint, points at a write on the
+ * lookup path (statistics, allocator state) or at false sharing. The
+ * bytes of the map object are also compared before and after each run,
+ * which catches writes to the map itself.
+ *
+ * Build with -pthread when compiling by hand.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+enum class Keys { shared, disjoint };
+enum class Call { count, at };
+
+struct ScalingResult {
+    double wall_ms = 0;         ///< first start to last finish
+    double slowest_ms = 0;      ///< longest single thread
+    double fastest_ms = 0;
+    size_t ops = 0;             ///< lookups over all threads
+    size_t found = 0;
+    bool modified = false;      ///< whether the map object changed
+};
+
+/**
+ * Runs `threads` readers of h at once. Each thread does `per_thread`
+ * lookups walking its key range from a different offset, so shared
+ * readers don't move in lockstep; results are written once at the end
+ * so the harness itself shares no cache lines while timing.
+ */
+template<class HMap>
+ScalingResult read_together(const HMap &h, const std::vector<_t> &keys, size_t threads, size_t per_thread,
+                            Keys mode, Call call) {
+    std::vector<char> before(sizeof(HMap));
+    std::memcpy(before.data(), static_cast<const void *>(&h), sizeof(HMap));
+
+    std::vector<double> ms(threads);
+    std::vector<size_t> found(threads);
+    std::vector<clock_type::time_point> ends(threads);
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> go(false);
+
+    auto reader = [&](size_t t) {
+        size_t begin = 0, size = keys.size();
+        if (mode == Keys::disjoint) {
+            begin = keys.size() * t / threads;
+            size = keys.size() * (t + 1) / threads - begin;
+        }
+        size_t at = mode == Keys::shared ? keys.size() * t / threads : 0;
+        size_t hits = 0;
+
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) { }
+
+        auto _start = clock_type::now();
+        for (size_t i = 0; i < per_thread; ++i) {
+            const _t &k = keys[begin + at];
+            if (call == Call::count) {
+                hits += h.count(k);
+            } else {
+                hits += h.at(k) == 42;
+            }
+            if (++at == size) at = 0;
+        }
+        ends[t] = clock_type::now();
+
+        ms[t] = std::chrono::duration<double, std::milli>(ends[t] - _start).count();
+        found[t] = hits;
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) pool.emplace_back(reader, t);
+    while (ready.load() < threads) std::this_thread::yield();
+
+    auto _start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &th : pool) th.join();
+
+    ScalingResult r;
+    r.fastest_ms = ms[0];
+    for (size_t t = 0; t < threads; ++t) {
+        double wall = std::chrono::duration<double, std::milli>(ends[t] - _start).count();
+        r.wall_ms = std::max(r.wall_ms, wall);
+        r.slowest_ms = std::max(r.slowest_ms, ms[t]);
+        r.fastest_ms = std::min(r.fastest_ms, ms[t]);
+        r.found += found[t];
+    }
+    r.ops = threads * per_thread;
+    r.modified = std::memcmp(before.data(), static_cast<const void *>(&h), sizeof(HMap)) != 0;
+    return r;
+}
+
+void _print_scaling(const ScalingResult &r, double single, const char *mode, const char *call, size_t threads) {
+    double aggregate = r.ops / r.wall_ms / 1000;
+    double per_thread = r.ops / threads / r.slowest_ms / 1000;
+
+    printf("| %-8s | %-5s | %3lu threads | %8.2f Mops/s per thread (fastest %8.2f) | %8.2f Mops/s total | x%5.2f |%s\n",
+           mode, call, threads, per_thread, r.ops / threads / r.fastest_ms / 1000, aggregate,
+           single > 0 ? aggregate / single : 1.0, r.modified ? " MAP MODIFIED BY READS" : "");
+}
+
+template<class HMap>
+void scaling_test(size_t n, size_t max_threads, std::string name) {
+    std::vector<_t> keys;
+    keys.reserve(n);
+    drt_testing::fill_vector(keys);
+
+    HMap h;
+    drt_testing::fill_map(keys, h);
+    drt_testing::shuffle_vector(keys);
+
+    // enough lookups per thread to outlast thread start-up
+    size_t per_thread = std::max<size_t>(n, 1000000);
+
+    int i = printf("| Read scaling [%lu] with %s, %lu lookups per thread |\n", n, name.c_str(), per_thread);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    // 1, 2, 4... and max_threads itself
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < max_threads; t *= 2) counts.push_back(t);
+    counts.push_back(max_threads);
+
+    const Keys modes[] = {Keys::shared, Keys::disjoint};
+    const Call calls[] = {Call::count, Call::at};
+
+    for (Call call : calls) {
+        for (Keys mode : modes) {
+            double single = 0;
+
+            for (size_t t : counts) {
+                ScalingResult r = read_together(h, keys, t, per_thread, mode, call);
+                if (t == 1) single = r.ops / r.wall_ms / 1000;
+
+                _print_scaling(r, single, mode == Keys::shared ? "shared" : "disjoint",
+                               call == Call::count ? "count" : "at", t);
+                if (r.found != r.ops) printf("| %lu of %lu lookups missed!\n", r.ops - r.found, r.ops);
+            }
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 3) {
+        std::cout << "Usage: read_scaling default|grouped|std <thousands> [<max threads>]\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[2], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000 * factor);
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 3) max_threads = std::max(1ul, std::strtoul(argv[3], nullptr, 10));
+
+    if (std::strcmp(argv[1], "std") == 0) {
+        scaling_test<std::unordered_map<_t, _t>>(n, max_threads, "std::unordered_map");
+    } else if (std::strcmp(argv[1], "grouped") == 0) {
+        scaling_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::GroupedPolicy>>(n, max_threads, "drt::Hashmap<Grouped>");
+    } else {
+        scaling_test<drt::Hashmap<_t, _t>>(n, max_threads, "drt::Hashmap");
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * What a rehash costs when it repacks the pools, against relinking nodes
+ * in place (in_place_rehash). Usage:
+ *
+ *   rehash_moves <millions>
+ *
+ * Each map is filled with random keys, growing as it goes, then rehashed
+ * once more to four times its size. It reports the time spent in the
+ * rehashes while filling and in the final one, the entries they moved
+ * between the element and node pools, the bytes per entry after filling
+ * and the time per hit.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+struct Repacking : drt::ChainedPolicy {
+    using stats = drt::collect_stats;
+};
+
+struct InPlace : Repacking {
+    using rehash = drt::in_place_rehash;
+};
+
+template<class Policy>
+void rehash_run(const std::vector<_t> &keys, const char *label) {
+    drt::Hashmap<_t, _t, std::hash<_t>, Policy> h;
+
+    for (const _t &k : keys) h[k] = k;
+
+    drt::MapStats grown = h.statistics();
+    double bytes = h.memory_usage().bytes_per_element();
+
+    h.reset_statistics();
+    h.rehash(4 * h.bucket_count());
+    drt::MapStats last = h.statistics();
+
+    size_t found = 0;
+    auto _start = clock_type::now();
+    for (const _t &k : keys) found += h.count(k);
+    double hit_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+    drt_testing::search_sink = found;
+
+    printf("| %-16s | %2lu rehashes %8.2f ms, moved %9lu | last rehash %8.2f ms, moved %9lu | %6.2f B/entry | hit %6.2f ns |\n",
+           label, grown.rehashes, grown.rehash_ns / 1e6, grown.rehash_moves,
+           last.rehash_ns / 1e6, last.rehash_moves, bytes, hit_ns);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: rehash_moves <millions>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000000 * factor);
+
+    std::vector<_t> keys;
+    keys.reserve(n);
+    drt_testing::fill_vector(keys);
+
+    int i = printf("| Rehash cost [%lu] with drt::Hashmap, ChainedPolicy |\n", n);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    rehash_run<Repacking>(keys, "repacking_rehash");
+    rehash_run<InPlace>(keys, "in_place_rehash");
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <memory>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Creates many tiny Hashmap<uint32_t, uint32_t>, as when keeping one map
+ * per search node, and reports the memory malloc handed out per map and
+ * the time to create, fill and then search all of them. Usage:
+ *
+ *   small_maps <thousands of maps> <elements per map> default|geometric|small|std
+ *
+ * With fixed 1 MB pools, `default` needs a pool per map as soon as two keys
+ * collide, so keep its map count low.
+ */
+
+using _t = uint32_t;
+
+struct GeometricPolicy : drt::MapPolicy {
+    using pool_size = drt::geometric_pool_size<>;
+};
+
+/// Scattered keys, so that small maps see realistic collisions.
+_t key(size_t map, size_t j) {
+    uint32_t x = static_cast<uint32_t>(map * 64 + j);
+    x ^= x >> 16;
+    x *= 0x85ebca6b;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35;
+    return x ^ (x >> 16);
+}
+
+template<class HMap>
+void small_maps_test(size_t maps, size_t elements, std::string name) {
+    using clock_type = std::chrono::steady_clock;
+
+    uint64_t before = drt_testing::current_heap_use();
+    auto _start = clock_type::now();
+
+    std::unique_ptr<HMap[]> all(new HMap[maps]);
+    for (size_t i = 0; i < maps; ++i) {
+        for (size_t j = 0; j < elements; ++j) {
+            all[i][key(i, j)] = j;
+        }
+    }
+
+    double fill_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+    uint64_t after = drt_testing::current_heap_use();
+
+    _start = clock_type::now();
+    size_t found = 0;
+    for (size_t i = 0; i < maps; ++i) {
+        for (size_t j = 0; j < elements; ++j) {
+            found += all[i].count(key(i, j));
+        }
+    }
+    drt_testing::search_sink = found;
+    double search_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+
+    printf("| %-9s [%lu maps x %lu] | %9.1f bytes/map | fill %8.2f ms | search %8.2f ms |\n",
+           name.c_str(), maps, elements, (double) (after - before) / maps, fill_ms, search_ms);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 4) {
+        std::cout << "Usage: small_maps <thousands of maps> <elements per map> default|geometric|small|std\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+
+    size_t maps = (size_t) (1000 * factor);
+    size_t elements = std::strtoul(argv[2], nullptr, 10);
+
+    if (std::strcmp(argv[3], "small") == 0) {
+        small_maps_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::SmallMapPolicy>>(maps, elements, "small");
+    } else if (std::strcmp(argv[3], "geometric") == 0) {
+        small_maps_test<drt::Hashmap<_t, _t, std::hash<_t>, GeometricPolicy>>(maps, elements, "geometric");
+    } else if (std::strcmp(argv[3], "std") == 0) {
+        small_maps_test<std::unordered_map<_t, _t>>(maps, elements, "std");
+    } else {
+        small_maps_test<drt::Hashmap<_t, _t>>(maps, elements, "default");
+    }
+
+    return 0;
+}
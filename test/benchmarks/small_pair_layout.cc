@@ -0,0 +1,67 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Bytes per entry and lookup time for Hashmap<uint32_t, uint32_t> with the
+ * element stored inline in the bucket array (the default for such small
+ * pairs) versus the chained layout. Run each layout in its own process so
+ * that the memory numbers don't interfere:
+ *
+ *   small_pair_layout 1 inline
+ *   small_pair_layout 1 chained
+ */
+
+template<class HMap>
+void layout_test(size_t num, std::string name) {
+    using _t = uint32_t;
+
+    std::vector<_t> v;
+    v.reserve(num);
+    drt_testing::fill_vector<_t>(v);
+
+    HMap h;
+    uint64_t before = drt_testing::current_process_vm();
+    drt_testing::fill_map<_t, HMap>(v, h);
+    uint64_t after = drt_testing::current_process_vm();
+
+    drt_testing::shuffle_vector<_t>(v);
+    auto _start = std::chrono::steady_clock::now();
+    drt_testing::search_map<_t, HMap>(v, h);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+
+    printf("| %-8s [%lu] | %7.2f MB | %6.2f bytes/entry | search %8.2f ms |\n",
+           name.c_str(), num, drt_testing::to_mb(after - before),
+           (double) (after - before) / h.size(), ms);
+}
+
+int main(int argc, char* argv[]) {
+
+    size_t millions = 0;
+
+    if (argc > 2) {
+        float factor = std::strtof(argv[1], nullptr);
+        if (factor <= 0.0) {
+            std::cout << "USE A POSITIVE NUMBER!!!\n";
+            return 0;
+        }
+        millions = (size_t) (1000000 * factor);
+    } else {
+        std::cout << "Usage: small_pair_layout <millions> inline|chained\n";
+        return 0;
+    }
+
+    using _t = uint32_t;
+
+    if (std::strcmp(argv[2], "inline") == 0) {
+        layout_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::InlinePolicy>>(millions, "inline");
+    } else {
+        layout_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::ChainedPolicy>>(millions, "chained");
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Iterating sparse maps, with and without an occupancy bitmap. Usage:
+ *
+ *   sparse_iteration <millions>
+ *
+ * For load factors from 0.1 to 1, a ChainedPolicy map is sized up front
+ * and filled with random keys. It reports the bucket bytes (bitmap
+ * included) and the time per insert, per iterated entry and per erase,
+ * for a map testing every bucket and for one using occupancy_bitmap.
+ */
+
+using _t = uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+struct Bitmap : drt::ChainedPolicy {
+    using occupancy = drt::occupancy_bitmap;
+};
+
+template<class Policy>
+void iteration_run(const std::vector<_t> &keys, float load, const char *label) {
+    drt::Hashmap<_t, _t, std::hash<_t>, Policy> h;
+    h.rehash((size_t) (keys.size() / load));
+    size_t bucket_bytes = h.memory_usage().bucket_bytes;
+
+    auto _start = clock_type::now();
+    for (const _t &k : keys) h[k] = k;
+    double insert_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+
+    _t sum = 0;
+    _start = clock_type::now();
+    for (auto it = h.begin(); it != h.end(); ++it) sum += it->second;
+    double iter_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / h.size();
+    drt_testing::search_sink = sum;
+
+    _start = clock_type::now();
+    for (const _t &k : keys) h.erase(k);
+    double erase_ns = std::chrono::duration<double, std::nano>(clock_type::now() - _start).count() / keys.size();
+
+    printf("| %-13s | lf %4.2f | %9lu buckets, %8.2f MB | insert %7.2f ns | iterate %7.2f ns/entry | erase %7.2f ns |\n",
+           label, load, h.bucket_count(), bucket_bytes / 1048576.0, insert_ns, iter_ns, erase_ns);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2) {
+        std::cout << "Usage: sparse_iteration <millions>\n";
+        return 0;
+    }
+
+    float factor = std::strtof(argv[1], nullptr);
+    if (factor <= 0.0) {
+        std::cout << "USE A POSITIVE NUMBER!!!\n";
+        return 0;
+    }
+    size_t n = (size_t) (1000000 * factor);
+
+    std::vector<_t> keys;
+    keys.reserve(n);
+    drt_testing::fill_vector(keys);
+
+    int i = printf("| Sparse iteration [%lu] with drt::Hashmap, ChainedPolicy |\n", n);
+    printf("%s\n", std::string(i - 1, '-').c_str());
+
+    const float loads[] = {0.1, 0.25, 0.5, 1.0};
+    for (float load : loads) {
+        iteration_run<drt::ChainedPolicy>(keys, load, "every bucket");
+        iteration_run<Bitmap>(keys, load, "bitmap");
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+
+#include "benchmark_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+/*
+ * Erase churn with compacting (stacked) versus stable pools. The map is
+ * filled, half of the keys are erased and then inserted again, reporting the
+ * time of each phase and the VmSize growth per live entry at the end. Run
+ * each layout in its own process:
+ *
+ *   stable_erase 1 stacked
+ *   stable_erase 1 stable
+ */
+
+template<class HMap>
+void churn_test(size_t num, std::string name) {
+    using _t = uint64_t;
+    using clock = std::chrono::steady_clock;
+
+    std::vector<_t> v;
+    v.reserve(num);
+    drt_testing::fill_vector<_t>(v);
+
+    HMap h;
+    uint64_t before = drt_testing::current_process_vm();
+    drt_testing::fill_map<_t, HMap>(v, h);
+
+    drt_testing::shuffle_vector<_t>(v);
+    std::vector<_t> half(v.begin(), v.begin() + num / 2);
+
+    auto _start = clock::now();
+    drt_testing::erase_map<_t, HMap>(half, h);
+    double erase_ms = std::chrono::duration<double, std::milli>(clock::now() - _start).count();
+
+    _start = clock::now();
+    drt_testing::fill_map<_t, HMap>(half, h);
+    double insert_ms = std::chrono::duration<double, std::milli>(clock::now() - _start).count();
+    uint64_t after = drt_testing::current_process_vm();
+
+    printf("| %-8s [%lu] | erase %8.2f ms | reinsert %8.2f ms | %6.2f bytes/entry |\n",
+           name.c_str(), num, erase_ms, insert_ms, (double) (after - before) / h.size());
+}
+
+int main(int argc, char* argv[]) {
+
+    size_t millions = 0;
+
+    if (argc > 2) {
+        float factor = std::strtof(argv[1], nullptr);
+        if (factor <= 0.0) {
+            std::cout << "USE A POSITIVE NUMBER!!!\n";
+            return 0;
+        }
+        millions = (size_t) (1000000 * factor);
+    } else {
+        std::cout << "Usage: stable_erase <millions> stacked|stable\n";
+        return 0;
+    }
+
+    using _t = uint64_t;
+
+    if (std::strcmp(argv[2], "stable") == 0) {
+        churn_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::StablePolicy>>(millions, "stable");
+    } else {
+        churn_test<drt::Hashmap<_t, _t, std::hash<_t>, drt::ChainedPolicy>>(millions, "stacked");
+    }
+
+    return 0;
+}
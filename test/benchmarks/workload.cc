@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+
+#include "dirtyMap/HashMap.hpp"
+#include "workload.hpp"
+
+/*
+ * Mixed workloads and trace replay. Usage:
+ *
+ *   workload gen <trace file> [name=value ...]
+ *   workload run <trace file> [map ...]
+ *   workload bench [name=value ...] [map ...]
+ *
+ * `gen` writes the operations of a generated workload to a file; `run`
+ * replays a file (generated, or recorded from production in the same
+ * format) against each map; `bench` does both without the file. The
+ * workload parameters are the fields of WorkloadConfig, e.g.
+ *
+ *   workload bench initial=1e6 ops=5e6 read=0.9 insert=0.08 erase=0.02 \
+ *                  prune=1e-6 theta=0.99 hit=0.5 burst=64 default std
+ *
+ * Maps: default, grouped, tagged, stable, std (all when none are given).
+ */
+
+using _t = uint64_t;
+using drt_testing::Trace;
+
+void run_maps(const Trace &t, std::vector<std::string> maps) {
+    if (maps.empty()) maps = {"default", "grouped", "tagged", "stable", "std"};
+
+    for (const std::string &m : maps) {
+        if (m == "grouped") {
+            drt_testing::_print_replay(drt_testing::replay<drt::Hashmap<_t, _t, std::hash<_t>, drt::GroupedPolicy>>(t), "drt::Hashmap<Grouped>");
+        } else if (m == "tagged") {
+            drt_testing::_print_replay(drt_testing::replay<drt::Hashmap<_t, _t, std::hash<_t>, drt::TaggedPolicy>>(t), "drt::Hashmap<Tagged>");
+        } else if (m == "stable") {
+            drt_testing::_print_replay(drt_testing::replay<drt::Hashmap<_t, _t, std::hash<_t>, drt::StablePolicy>>(t), "drt::Hashmap<Stable>");
+        } else if (m == "std") {
+            drt_testing::_print_replay(drt_testing::replay<std::unordered_map<_t, _t>>(t), "std::unordered_map");
+        } else if (m == "default") {
+            drt_testing::_print_replay(drt_testing::replay<drt::Hashmap<_t, _t>>(t), "drt::Hashmap");
+        } else {
+            std::cout << "Unknown map " << m << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc < 2 || (std::strcmp(argv[1], "bench") != 0 && argc < 3)) {
+        std::cout << "Usage: workload gen <trace file> [name=value ...]\n"
+                     "       workload run <trace file> [map ...]\n"
+                     "       workload bench [name=value ...] [map ...]\n";
+        return 0;
+    }
+
+    std::string mode = argv[1];
+    int first = mode == "bench" ? 2 : 3;
+
+    drt_testing::WorkloadConfig config;
+    std::vector<std::string> maps;
+
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg.find('=') == std::string::npos) {
+            maps.push_back(arg);
+        } else if (!config.set(arg)) {
+            std::cout << "Unknown parameter " << arg << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        if (mode == "run") {
+            run_maps(drt_testing::read_trace(argv[2]), maps);
+            return 0;
+        }
+
+        Trace t;
+        t.initial = config.initial;
+        t.ops = drt_testing::generate_workload(config);
+
+        size_t counts[4] = {0, 0, 0, 0};
+        for (size_t i = t.initial; i < t.ops.size(); ++i) counts[t.ops[i].type] += 1;
+        printf("%lu loads, then %lu finds, %lu inserts, %lu erases, %lu prunes\n",
+               (size_t) t.initial, counts[0], counts[1], counts[2], counts[3]);
+
+        if (mode == "gen") {
+            drt_testing::write_trace(argv[2], t);
+        } else {
+            run_maps(t, maps);
+        }
+    } catch (const std::exception &e) {
+        std::cout << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,330 @@
+#ifndef FYP_MAPS_WORKLOAD_HPP
+#define FYP_MAPS_WORKLOAD_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.hpp"
+
+namespace drt_testing {
+
+    /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *          WORKLOAD GENERATION
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     */
+
+    /// One map operation. For prune, key is the percentage of keys removed.
+    struct Op {
+        enum type_t : uint8_t { find, insert, erase, prune };
+
+        type_t type;
+        uint64_t key;
+    };
+
+    /**
+     * Shape of a mixed workload. Ratios are relative weights of the
+     * operations after the initial load, and needn't sum to 1.
+     */
+    struct WorkloadConfig {
+        size_t initial    = 1000000;  ///< keys inserted before the mix starts
+        size_t ops        = 1000000;  ///< operations in the mix
+        double read       = 0.8;
+        double insert     = 0.15;
+        double erase      = 0.05;
+        double prune      = 0;        ///< e.g. 1e-5 for one prune per 100K ops
+        unsigned prune_pct = 10;      ///< share of the keys each prune removes
+        double hit        = 0.9;      ///< share of reads looking for a present key
+        double theta      = 0.99;     ///< zipf skew of reads and erases; 0 is uniform
+        size_t burst      = 1;        ///< inserts arrive in runs of this many
+        bool sequential   = false;    ///< keys 0, 1, 2... rather than scattered
+        uint64_t seed     = 42;
+
+        /// Sets a field from "name=value"; @return false if name is unknown.
+        bool set(const std::string &arg) {
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos) return false;
+
+            std::string name = arg.substr(0, eq);
+            double v = std::strtod(arg.c_str() + eq + 1, nullptr);
+
+            if (name == "initial") initial = static_cast<size_t>(v);
+            else if (name == "ops") ops = static_cast<size_t>(v);
+            else if (name == "read") read = v;
+            else if (name == "insert") insert = v;
+            else if (name == "erase") erase = v;
+            else if (name == "prune") prune = v;
+            else if (name == "prune_pct") prune_pct = static_cast<unsigned>(v);
+            else if (name == "hit") hit = v;
+            else if (name == "theta") theta = v;
+            else if (name == "burst") burst = std::max<size_t>(1, static_cast<size_t>(v));
+            else if (name == "sequential") sequential = v != 0;
+            else if (name == "seed") seed = static_cast<uint64_t>(v);
+            else return false;
+            return true;
+        }
+    };
+
+    /// Whether prune(pct) removes key: the same rule for every map.
+    inline bool pruned(uint64_t key, uint64_t pct) {
+        return (key * 0x9E3779B97F4A7C15ULL >> 32) % 100 < pct;
+    }
+
+    /**
+     * Zipf-distributed ranks in [0, n) for a population that grows and
+     * shrinks one at a time (Gray et al., as in YCSB). Rank 0 is the most
+     * popular. zeta(n) is updated incrementally, so theta must not be 1.
+     */
+    class zipf_ranks {
+        double theta, zeta2, zetan = 0;
+        size_t n = 0;
+
+    public:
+        explicit zipf_ranks(double t) : theta(t), zeta2(1 + std::pow(0.5, t)) { }
+
+        void grow() { zetan += std::pow(static_cast<double>(++n), -theta); }
+
+        void shrink() { zetan -= std::pow(static_cast<double>(n--), -theta); }
+
+        template<class Rng>
+        size_t operator()(Rng &rng) const {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            if (theta == 0 || n < 2) return static_cast<size_t>(u * n);
+
+            double uz = u * zetan;
+            if (uz < 1) return 0;
+            if (uz < zeta2) return 1;
+
+            double eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zetan);
+            size_t r = static_cast<size_t>(n * std::pow(eta * u - eta + 1, 1 / (1 - theta)));
+            return std::min(r, n - 1);
+        }
+    };
+
+    /**
+     * Generates the operations of a workload: `initial` inserts, then the
+     * mix. Keys are numbered in insertion order and scattered with a
+     * bijective mix unless sequential; misses use numbers never inserted.
+     */
+    inline std::vector<Op> generate_workload(const WorkloadConfig &c) {
+        std::mt19937_64 rng(c.seed);
+        std::vector<uint64_t> live;       // in insertion order, roughly
+        zipf_ranks ranks(c.theta);
+        uint64_t next = 0;                // keys ever inserted
+        uint64_t missing = 1ULL << 62;    // keys never inserted
+
+        auto key_of = [&](uint64_t i) -> uint64_t {
+            if (c.sequential) return i;
+            // splitmix64 finaliser, a bijection
+            i += 0x9E3779B97F4A7C15ULL;
+            i = (i ^ (i >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            i = (i ^ (i >> 27)) * 0x94D049BB133111EBULL;
+            return i ^ (i >> 31);
+        };
+
+        std::vector<Op> ops;
+        ops.reserve(c.initial + c.ops + c.burst);
+
+        auto add = [&]() {
+            uint64_t k = key_of(next++);
+            live.push_back(k);
+            ranks.grow();
+            ops.push_back(Op{Op::insert, k});
+        };
+
+        for (size_t i = 0; i < c.initial; ++i) add();
+
+        // an insert event emits a whole burst
+        double weights[] = {c.read, c.insert / c.burst, c.erase, c.prune};
+        std::discrete_distribution<int> pick(std::begin(weights), std::end(weights));
+        std::uniform_real_distribution<double> coin(0, 1);
+
+        while (ops.size() < c.initial + c.ops) {
+            switch (pick(rng)) {
+                case Op::find:
+                    if (!live.empty() && coin(rng) < c.hit) {
+                        ops.push_back(Op{Op::find, live[ranks(rng)]});
+                    } else {
+                        ops.push_back(Op{Op::find, key_of(missing++)});
+                    }
+                    break;
+
+                case Op::insert:
+                    for (size_t b = 0; b < c.burst; ++b) add();
+                    break;
+
+                case Op::erase: {
+                    if (live.empty()) break;
+                    size_t r = ranks(rng);
+                    ops.push_back(Op{Op::erase, live[r]});
+                    live[r] = live.back();
+                    live.pop_back();
+                    ranks.shrink();
+                    break;
+                }
+
+                case Op::prune: {
+                    ops.push_back(Op{Op::prune, c.prune_pct});
+                    size_t kept = 0;
+                    for (uint64_t k : live) {
+                        if (!pruned(k, c.prune_pct)) live[kept++] = k;
+                    }
+                    while (live.size() > kept) {
+                        live.pop_back();
+                        ranks.shrink();
+                    }
+                    break;
+                }
+            }
+        }
+
+        return ops;
+    }
+
+    /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *               TRACES
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *
+     * "DRTTRACE", then u32 version, u64 load count and u64 op count, then
+     * 9 bytes per op: u8 type and u64 key, all little-endian as on x86.
+     */
+
+    struct Trace {
+        uint64_t initial = 0;   ///< leading ops that are the load phase
+        std::vector<Op> ops;
+    };
+
+    inline void write_trace(const std::string &path, const Trace &t) {
+        FILE *f = std::fopen(path.c_str(), "wb");
+        if (!f) throw std::runtime_error("cannot write " + path);
+
+        const uint32_t version = 1;
+        uint64_t count = t.ops.size();
+        std::fwrite("DRTTRACE", 1, 8, f);
+        std::fwrite(&version, sizeof(version), 1, f);
+        std::fwrite(&t.initial, sizeof(t.initial), 1, f);
+        std::fwrite(&count, sizeof(count), 1, f);
+
+        for (const Op &op : t.ops) {
+            std::fwrite(&op.type, 1, 1, f);
+            std::fwrite(&op.key, sizeof(op.key), 1, f);
+        }
+        std::fclose(f);
+    }
+
+    inline Trace read_trace(const std::string &path) {
+        FILE *f = std::fopen(path.c_str(), "rb");
+        if (!f) throw std::runtime_error("cannot read " + path);
+
+        char magic[8];
+        uint32_t version = 0;
+        uint64_t count = 0;
+        Trace t;
+
+        bool ok = std::fread(magic, 1, 8, f) == 8 && std::memcmp(magic, "DRTTRACE", 8) == 0
+                  && std::fread(&version, sizeof(version), 1, f) == 1 && version == 1
+                  && std::fread(&t.initial, sizeof(t.initial), 1, f) == 1
+                  && std::fread(&count, sizeof(count), 1, f) == 1;
+
+        for (uint64_t i = 0; ok && i < count; ++i) {
+            Op op;
+            ok = std::fread(&op.type, 1, 1, f) == 1 && std::fread(&op.key, sizeof(op.key), 1, f) == 1
+                 && op.type <= Op::prune;
+            t.ops.push_back(op);
+        }
+        std::fclose(f);
+
+        if (!ok) throw std::runtime_error(path + " is not a valid trace");
+        return t;
+    }
+
+    /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     *                REPLAY
+     * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+     */
+
+    /// Removes the keys selected by prune, one by one for most maps...
+    template<class HMap>
+    size_t prune_map(HMap &h, uint64_t pct) {
+        size_t before = h.size();
+        for (auto it = h.begin(); it != h.end();) {
+            if (pruned(it->first, pct)) it = h.erase(it);
+            else ++it;
+        }
+        return before - h.size();
+    }
+
+    /// ... and in one compacting pass for drt::Hashmap.
+    template<class K, class V, class H, class P>
+    size_t prune_map(drt::Hashmap<K, V, H, P> &h, uint64_t pct) {
+        return h.erase_if([pct](const std::pair<const K, V> &e) { return pruned(e.first, pct); });
+    }
+
+    struct ReplayResult {
+        double load_ms = 0;
+        double run_ms = 0;
+        size_t run_ops = 0;
+        size_t hits = 0;         ///< finds that succeeded, to check maps agree
+        size_t final_size = 0;
+        uint64_t load_bytes = 0; ///< heap held after the load phase
+        uint64_t end_bytes = 0;  ///< and at the end
+    };
+
+    /// Applies a trace to a fresh map, timing the load and the mix apart.
+    template<class HMap>
+    ReplayResult replay(const Trace &t) {
+        using clock_type = std::chrono::steady_clock;
+        ReplayResult r;
+
+        uint64_t base = current_heap_use();
+        HMap *h = new HMap();
+
+        auto apply = [&](const Op &op) {
+            switch (op.type) {
+                case Op::find:
+                    r.hits += h->count(op.key);
+                    break;
+                case Op::insert:
+                    (*h)[op.key] = op.key;
+                    break;
+                case Op::erase:
+                    h->erase(op.key);
+                    break;
+                case Op::prune:
+                    prune_map(*h, op.key);
+                    break;
+            }
+        };
+
+        size_t split = std::min<size_t>(t.initial, t.ops.size());
+
+        auto _start = clock_type::now();
+        for (size_t i = 0; i < split; ++i) apply(t.ops[i]);
+        r.load_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+        r.load_bytes = current_heap_use() - base;
+
+        _start = clock_type::now();
+        for (size_t i = split; i < t.ops.size(); ++i) apply(t.ops[i]);
+        r.run_ms = std::chrono::duration<double, std::milli>(clock_type::now() - _start).count();
+        r.end_bytes = current_heap_use() - base;
+
+        r.run_ops = t.ops.size() - split;
+        r.final_size = h->size();
+        delete h;
+        return r;
+    }
+
+    void _print_replay(const ReplayResult &r, string _m) {
+        printf("| %-22s | load %9.2f ms | mix %9.2f ms | %7.2f Mops/s | %8.2f MB -> %8.2f MB | %lu hits, %lu left |\n",
+               _m.c_str(), r.load_ms, r.run_ms, r.run_ms > 0 ? r.run_ops / r.run_ms / 1000 : 0,
+               r.load_bytes / 1048576.0, r.end_bytes / 1048576.0, r.hits, r.final_size);
+    }
+
+} // namespace drt_testing
+
+#endif //FYP_MAPS_WORKLOAD_HPP
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "gtest/gtest.h"
 #include "test_utils.hpp"
 #include "dirtyMap/Allocator.hpp"
@@ -89,3 +90,78 @@ TEST_F(AllocTest, iterators3) {
 TEST_F(AllocTest, emptyIterators) {
     ASSERT_TRUE(empty.begin() == empty.end());
 }
+
+TEST_F(AllocTest, lazyPools) {
+    ASSERT_EQ(0, empty.pool_count());
+    ASSERT_EQ(0, empty.capacity_bytes());
+
+    addElements(0, 1, empty, v);
+    ASSERT_EQ(1, empty.pool_count());
+
+    empty.destroyAll();
+    ASSERT_EQ(0, empty.pool_count());
+    ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+TEST_F(AllocTest, usage) {
+    AllocatorUsage u = empty.usage();
+    ASSERT_EQ(0, u.pools);
+    ASSERT_EQ(0, u.fill_ratio());
+
+    addElements(5, 6, alloc, v);
+    u = alloc.usage();
+    ASSERT_EQ(2, u.pools);
+    ASSERT_EQ(6, u.objects);
+    ASSERT_EQ(6 * sizeof(int), u.used_bytes);
+    ASSERT_EQ(alloc.capacity_bytes(), u.reserved_bytes);
+    ASSERT_EQ(2, u.fill.size());
+    ASSERT_FLOAT_EQ(1.2f, u.fill[0] + u.fill[1]);
+    ASSERT_FLOAT_EQ(0.6f, u.fill_ratio());
+}
+
+TEST_F(AllocTest, releaseAcrossPools) {
+    addElements(5, 15, alloc, v);
+    ASSERT_EQ(3, alloc.pool_count());
+
+    // holes in every pool, out of address order
+    std::vector<void*> holes = {v[13], v[1], v[7], v[4], v[10], v[2], v[14]};
+    int moves = 0;
+    alloc.release(holes, [&](void*, void*) { ++moves; });
+
+    std::vector<int> left;
+    for (auto it = alloc.begin(); it != alloc.end(); ++it) left.push_back(*it);
+    std::sort(left.begin(), left.end());
+
+    ASSERT_EQ(std::vector<int>({0, 3, 5, 6, 8, 9, 11, 12}), left);
+    ASSERT_GT(moves, 0);
+}
+
+TEST(AllocSizingTest, geometricGrowth) {
+    // 16, 32, 64 bytes, then capped at 64 bytes per pool
+    DtPoolAllocator<int, five_count, stacked_pools, geometric_pool_size<16, 64>> a;
+
+    std::vector<int*> v;
+    for (int i = 0; i < 4 + 8 + 16 + 16; ++i) {
+        void* ptr = a.allocate();
+        v.push_back(static_cast<int*>(ptr));
+        new(ptr) int(i);
+    }
+
+    ASSERT_EQ(4, a.pool_count());
+    ASSERT_EQ(16 + 32 + 64 + 64, a.capacity_bytes());
+
+    int n = 0;
+    for (auto it = a.begin(); it != a.end(); ++it) ++n;
+    ASSERT_EQ(44, n);
+
+    // starts over from the first size
+    a.destroyAll();
+    a.allocate();
+    ASSERT_EQ(16, a.capacity_bytes());
+}
+
+TEST(AllocSizingTest, poolBytes) {
+    DtPoolAllocator<int, five_count, stable_pools, pool_bytes<4096>> a;
+    a.allocate();
+    ASSERT_EQ(4096 + 1024 / 8, a.capacity_bytes());
+}
@@ -0,0 +1,114 @@
+#include <functional>
+#include "gtest/gtest.h"
+#include "test_utils.hpp"
+#include "dirtyMap/FlatMap.hpp"
+
+using namespace drt;
+
+/*
+ * ZeroHF sends every key to the same group with the same fingerprint, so
+ * these tests exercise the probe sequence and tombstone handling.
+ */
+
+class FlatMapTest : public ::testing::Test {
+
+protected:
+    using hmap = FlatDirtyMap<int, int, ZeroHF<int>>;
+
+    hmap h;
+};
+
+TEST_F(FlatMapTest, TestEmpty) {
+    EXPECT_TRUE(h.empty());
+    EXPECT_EQ(0, h.size());
+    EXPECT_EQ(0, h.bucket_count());
+    EXPECT_EQ(0, h.count(1));
+    EXPECT_TRUE(h.begin() == h.end());
+}
+
+TEST_F(FlatMapTest, TestInsert) {
+    h[1] = 2;
+    h[2] = 3;
+    ASSERT_EQ(2, h[1]);
+    ASSERT_EQ(3, h[2]);
+    ASSERT_EQ(2, h.size());
+    ASSERT_EQ(16, h.bucket_count());
+}
+
+TEST_F(FlatMapTest, TestCollisionsSpanGroups) {
+    for (int i = 0; i < 100; ++i) {
+        h[i] = i;
+    }
+
+    ASSERT_EQ(100, h.size());
+    ASSERT_LE(h.load_factor(), h.max_load_factor());
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(i, h.at(i));
+    }
+    ASSERT_EQ(0, h.count(100));
+}
+
+TEST_F(FlatMapTest, TestErase) {
+    for (int i = 0; i < 40; ++i) {
+        h[i] = i;
+    }
+
+    EXPECT_EQ(0, h.erase(40));
+
+    for (int i = 0; i < 40; i += 2) {
+        EXPECT_EQ(1, h.erase(i));
+    }
+
+    EXPECT_EQ(20, h.size());
+
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_EQ(i % 2, h.count(i));
+    }
+
+    // reinsertion reuses tombstones
+    h[0] = 7;
+    EXPECT_EQ(7, h.at(0));
+    EXPECT_EQ(21, h.size());
+}
+
+TEST_F(FlatMapTest, TestAtThrows) {
+    EXPECT_THROW(h.at(3), std::out_of_range);
+}
+
+TEST_F(FlatMapTest, TestIterate) {
+    FlatDirtyMap<int, int, std::hash<int>> m;
+    int sum = 0;
+
+    for (int i = 1; i <= 1000; ++i) {
+        m[i] = i;
+        sum += i;
+    }
+
+    int seen = 0;
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        ASSERT_EQ(it->first, it->second);
+        seen += it->second;
+    }
+
+    EXPECT_EQ(sum, seen);
+}
+
+TEST_F(FlatMapTest, TestClear) {
+    FlatDirtyMap<int, TestFoo<int>> m(64);
+    for (int i = 0; i < 20; ++i) {
+        m[i];
+    }
+
+    m.clear();
+    EXPECT_EQ(0, m.size());
+    EXPECT_EQ(64, m.bucket_count());
+    EXPECT_EQ(0, m.count(3));
+}
+
+TEST_F(FlatMapTest, TestMove) {
+    h[1] = 1;
+    hmap m(std::move(h));
+    EXPECT_EQ(1, m.at(1));
+    EXPECT_EQ(0, h.size());
+}
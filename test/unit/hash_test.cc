@@ -0,0 +1,71 @@
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "dirtyMap/HashMap.hpp"
+
+using namespace drt;
+
+/*
+ * Test the built-in hash functions: that they are deterministic, keep
+ * distinct keys apart, and spread structured keys over the low bits.
+ */
+
+TEST(HashTest, deterministic) {
+    EXPECT_EQ(hash<uint64_t>()(12345), hash<uint64_t>()(12345));
+    EXPECT_EQ(hash<std::string>()("dirty"), hash<std::string>()(std::string("dirty")));
+    EXPECT_EQ(hash_bytes("abc", 3), hash_bytes("abc", 3));
+    EXPECT_NE(hash_bytes("abc", 3, 1), hash_bytes("abc", 3, 2));
+}
+
+TEST(HashTest, everyLength) {
+    // each length takes its own path through hash_bytes, up to the 48 byte rounds
+    std::string s(200, 'x');
+    std::set<uint64_t> seen;
+
+    for (size_t len = 0; len <= s.size(); ++len) {
+        seen.insert(hash_bytes(s.data(), len));
+    }
+    EXPECT_EQ(s.size() + 1, seen.size());
+
+    // one flipped byte changes the hash, wherever it is
+    for (size_t i = 0; i < 100; ++i) {
+        std::string t = s.substr(0, 100);
+        t[i] = 'y';
+        EXPECT_NE(hash_bytes(s.data(), 100), hash_bytes(t.data(), 100)) << "byte " << i;
+    }
+}
+
+TEST(HashTest, lowBitsSpread) {
+    // keys a multiple of 64 apart share their low six bits
+    const size_t buckets = 1024;
+    std::vector<size_t> counts(buckets);
+
+    for (uint64_t i = 0; i < 16 * buckets; ++i) {
+        ++counts[hash<uint64_t>()(i * 64) & (buckets - 1)];
+    }
+
+    size_t empty = 0, longest = 0;
+    for (size_t c : counts) {
+        empty += c == 0;
+        longest = std::max(longest, c);
+    }
+    EXPECT_EQ(0, empty);
+    EXPECT_GT(40, longest);
+}
+
+TEST(HashTest, inHashmap) {
+    Hashmap<std::string, int, hash<std::string>> m;
+    Hashmap<int, int, hash<int>, GroupedPolicy> g;
+
+    for (int i = 0; i < 1000; ++i) {
+        m[std::to_string(i)] = i;
+        g[i] = -i;
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i, m.at(std::to_string(i)));
+        EXPECT_EQ(-i, g.at(i));
+    }
+    EXPECT_EQ(0, m.count("1000"));
+}
@@ -0,0 +1,964 @@
+#include <functional>
+#include <random>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include "gtest/gtest.h"
+#include "test_utils.hpp"
+#include "dirtyMap/HashMap.hpp"
+
+using namespace drt;
+
+/*
+ * Every bucket policy must behave exactly like the default one. Each test
+ * runs once per policy, both with ZeroHF (everything in one bucket) and
+ * against std::unordered_map with random keys.
+ */
+
+template<typename P>
+class PolicyTest : public ::testing::Test {
+
+protected:
+    using hmap = Hashmap<int, int, ZeroHF<int>, P>;
+    using rmap = Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, P>;
+
+    hmap h;
+};
+
+/// Tiny, growing pools, so that even small tests span many pools.
+struct GrowingPolicy : ChainedPolicy {
+    using pool_size = geometric_pool_size<256, 4096>;
+};
+
+/// Statistics must not change behaviour.
+struct CountingPolicy : GroupedPolicy {
+    using stats = collect_stats;
+};
+
+/// Prime bucket counts, growing by half.
+struct PrimePolicy : ChainedPolicy {
+    using growth = prime_growth<3, 2>;
+};
+
+/// Three entries per bucket before growing.
+struct DensePolicy : MapPolicy {
+    using growth = dense_growth<>;
+};
+
+/// Linear hashing with pools that leave holes, so chains may end in a node.
+struct LinearStablePolicy : LinearPolicy {
+    using pools = stable_pools;
+};
+
+/// Compacting pools whose chains may end in a node after a rehash.
+struct InPlacePolicy : ChainedPolicy {
+    using rehash = in_place_rehash;
+};
+
+struct OccupancyPolicy : MapPolicy {
+    using occupancy = occupancy_bitmap;
+};
+
+struct LinearOccupancyPolicy : LinearPolicy {
+    using occupancy = occupancy_bitmap;
+};
+
+using Policies = ::testing::Types<MapPolicy, ChainedPolicy, GroupedPolicy, TaggedPolicy, InlinePolicy,
+        StablePolicy, GrowingPolicy, SmallMapPolicy, CountingPolicy, PrimePolicy, DensePolicy,
+        LinearPolicy, LinearStablePolicy, InPlacePolicy, OccupancyPolicy, LinearOccupancyPolicy>;
+TYPED_TEST_SUITE(PolicyTest, Policies);
+
+TYPED_TEST(PolicyTest, collisions) {
+    for (int i = 0; i < 20; ++i) {
+        this->h[i] = i;
+    }
+
+    EXPECT_EQ(20, this->h.size());
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i, this->h.at(i));
+    }
+    EXPECT_EQ(0, this->h.count(20));
+
+    // lookups through a const map, as concurrent readers would do
+    const auto &c = this->h;
+    EXPECT_EQ(7, c.at(7));
+    EXPECT_THROW(c.at(20), std::out_of_range);
+}
+
+TYPED_TEST(PolicyTest, eraseCollisions) {
+    for (int i = 0; i < 20; ++i) {
+        this->h[i] = i;
+    }
+
+    for (int i = 0; i < 20; i += 3) {
+        EXPECT_EQ(1, this->h.erase(i));
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i % 3 != 0, this->h.count(i));
+    }
+
+    // refill the holes
+    for (int i = 0; i < 20; i += 3) {
+        this->h[i] = -i;
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i % 3 ? i : -i, this->h.at(i));
+    }
+}
+
+TYPED_TEST(PolicyTest, iterate) {
+    for (int i = 0; i < 20; ++i) {
+        this->h[i] = i;
+    }
+
+    int seen = 0;
+    for (auto it = this->h.begin(); it != this->h.end(); ++it) {
+        EXPECT_EQ(it->first, it->second);
+        seen += 1;
+    }
+    EXPECT_EQ(20, seen);
+}
+
+/// Checks m against ref by lookup and by iteration.
+template<typename M>
+void expect_same(M &m, std::unordered_map<uint64_t, uint64_t> &ref) {
+    ASSERT_EQ(ref.size(), m.size());
+
+    for (auto &p : ref) {
+        ASSERT_EQ(p.second, m.at(p.first));
+    }
+
+    size_t seen = 0;
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        ASSERT_EQ(ref[it->first], it->second);
+        ++seen;
+    }
+    ASSERT_EQ(ref.size(), seen);
+}
+
+TYPED_TEST(PolicyTest, matchesStd) {
+    typename TestFixture::rmap m;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < 20000; ++i) {
+        // small key range so that erases and reinserts hit
+        uint64_t k = rng() % 8000;
+
+        if (rng() % 3 == 0) {
+            ASSERT_EQ(ref.erase(k), m.erase(k));
+        } else {
+            m[k] = i;
+            ref[k] = i;
+        }
+    }
+
+    expect_same(m, ref);
+}
+
+TYPED_TEST(PolicyTest, eraseIfCollisions) {
+    for (int i = 0; i < 20; ++i) {
+        this->h[i] = i;
+    }
+
+    EXPECT_EQ(7, this->h.erase_if([](std::pair<const int, int> &p) { return p.first % 3 == 0; }));
+    EXPECT_EQ(13, this->h.size());
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i % 3 != 0, this->h.count(i));
+    }
+
+    // most of what's left, so the buckets are relinked instead of patched
+    EXPECT_EQ(9, this->h.erase_if([](std::pair<const int, int> &p) { return p.first > 5; }));
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i % 3 != 0 && i <= 5, this->h.count(i));
+    }
+}
+
+TYPED_TEST(PolicyTest, eraseIfMatchesStd) {
+    typename TestFixture::rmap m;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t k = rng();
+        m[k] = i;
+        ref[k] = i;
+    }
+
+    // a few holes, then more holes than survivors
+    for (uint64_t mod : {5, 2}) {
+        size_t erased = m.erase_if([mod](std::pair<const uint64_t, uint64_t> &p) { return p.second % mod == 0; });
+        size_t expected = 0;
+
+        for (auto it = ref.begin(); it != ref.end();) {
+            if (it->second % mod == 0) {
+                it = ref.erase(it);
+                ++expected;
+            } else {
+                ++it;
+            }
+        }
+
+        ASSERT_EQ(expected, erased);
+        expect_same(m, ref);
+    }
+}
+
+TYPED_TEST(PolicyTest, eraseBatch) {
+    typename TestFixture::rmap m;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    std::vector<uint64_t> doomed;
+
+    for (uint64_t i = 0; i < 5000; ++i) {
+        m[i] = i;
+        ref[i] = i;
+        if (i % 4 == 1) doomed.push_back(i);
+    }
+
+    // missing and repeated keys are ignored
+    doomed.push_back(10000);
+    doomed.push_back(1);
+
+    EXPECT_EQ(1250, m.erase_batch(doomed));
+    for (uint64_t k : doomed) ref.erase(k);
+    expect_same(m, ref);
+
+    // the map is still usable afterwards
+    for (uint64_t k : doomed) {
+        m[k] = k;
+        ref[k] = k;
+    }
+    expect_same(m, ref);
+}
+
+TYPED_TEST(PolicyTest, eraseIterator) {
+    for (int i = 0; i < 20; ++i) {
+        this->h[i] = i;
+    }
+
+    int seen = 0;
+    for (auto it = this->h.begin(); it != this->h.end(); ++seen) {
+        if (it->first % 2) {
+            it = this->h.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    EXPECT_EQ(20, seen);
+    EXPECT_EQ(10, this->h.size());
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i % 2 == 0, this->h.count(i));
+    }
+}
+
+TYPED_TEST(PolicyTest, probeCount) {
+    using bucket = typename TypeParam::template bucket<int, std::pair<const int, int>>;
+    // inline buckets and the small mode find the first element without leaving the array
+    const size_t first = drtx::stores_inline<bucket>::value || TypeParam::small_size ? 0 : 1;
+
+    this->h[1] = 1;
+    EXPECT_EQ(first, this->h.probe_count(1));
+    // same bucket and fingerprint, so a miss reads the element too
+    EXPECT_EQ(first, this->h.probe_count(2));
+}
+
+TYPED_TEST(PolicyTest, optimizeLayout) {
+    typename TestFixture::rmap m;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    std::mt19937_64 rng(11);
+
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t k = rng() % 8000;
+
+        if (rng() % 3 == 0) {
+            ref.erase(k);
+            m.erase(k);
+        } else {
+            m[k] = i;
+            ref[k] = i;
+        }
+    }
+
+    m.optimize_layout();
+    expect_same(m, ref);
+
+    for (int i = 0; i < 20; ++i) {
+        this->h[i] = i;
+    }
+    this->h.erase(5);
+    this->h.optimize_layout();
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i == 5 ? 0 : 1, this->h.count(i));
+    }
+
+    // the map is still usable afterwards
+    this->h[5] = 5;
+    EXPECT_EQ(1, this->h.erase(0));
+    EXPECT_EQ(19, this->h.size());
+    EXPECT_EQ(5, this->h.at(5));
+}
+
+TEST(TaggedTest, missSkipsElement) {
+    Hashmap<int, int, std::hash<int>, TaggedPolicy> m;
+    Hashmap<int, int, std::hash<int>, ChainedPolicy> plain;
+    m[1] = 1;
+    plain[1] = 1;
+
+    // one bucket, so 2 lands next to 1; only the untagged map reads it
+    ASSERT_EQ(1, m.bucket_count());
+    EXPECT_EQ(0, m.probe_count(2));
+    EXPECT_EQ(1, plain.probe_count(2));
+    EXPECT_EQ(1, m.probe_count(1));
+}
+
+TEST(InlineTest, selectedForSmallPairs) {
+    Hashmap<uint32_t, uint32_t, ZeroHF<uint32_t>> m;
+
+    // the first element is read from the bucket array, only collisions probe
+    m[1] = 1;
+    m[2] = 2;
+    EXPECT_EQ(0, m.probe_count(1));
+    EXPECT_EQ(1, m.probe_count(2));
+
+    // removing the inline element pulls the first collision into the slot
+    m.erase(1);
+    EXPECT_EQ(2, m.at(2));
+    EXPECT_EQ(0, m.probe_count(2));
+}
+
+TEST(StableTest, addressesSurviveErase) {
+    Hashmap<int, int, ZeroHF<int>, StablePolicy> m;
+    m.rehash(8);
+    std::vector<int*> refs;
+
+    for (int i = 0; i < 6; ++i) {
+        refs.push_back(&m[i]);
+        *refs.back() = i;
+    }
+
+    // erase head, middle and tail of the chain
+    m.erase(5);
+    m.erase(2);
+    m.erase(0);
+
+    for (int i : {1, 3, 4}) {
+        EXPECT_EQ(refs[i], &m.at(i));
+        EXPECT_EQ(i, *refs[i]);
+    }
+    EXPECT_EQ(3, m.size());
+}
+
+TEST(EraseIfTest, nonTrivialValues) {
+    Hashmap<int, std::string, ZeroHF<int>> m;
+
+    for (int i = 0; i < 50; ++i) {
+        m[i] = std::string(40, 'a' + i % 26);
+    }
+
+    EXPECT_EQ(25, m.erase_if([](std::pair<const int, std::string> &p) { return p.first % 2; }));
+
+    for (int i = 0; i < 50; ++i) {
+        if (i % 2) {
+            EXPECT_EQ(0, m.count(i));
+        } else {
+            EXPECT_EQ(std::string(40, 'a' + i % 26), m.at(i));
+        }
+    }
+}
+
+TEST(SmallMapTest, staysSmallThenPromotes) {
+    Hashmap<int, int, std::hash<int>, SmallMapPolicy> m;
+    EXPECT_EQ(0, m.bucket_count());
+
+    for (int i = 0; i < 8; ++i) {
+        m[i] = i * 10;
+    }
+
+    // still no buckets
+    EXPECT_EQ(0, m.bucket_count());
+    EXPECT_EQ(8, m.size());
+    EXPECT_EQ(70, m.at(7));
+    EXPECT_EQ(0, m.count(8));
+    EXPECT_THROW(m.at(8), std::out_of_range);
+
+    m[8] = 80;
+    EXPECT_LT(0, m.bucket_count());
+    EXPECT_EQ(9, m.size());
+
+    for (int i = 0; i < 9; ++i) {
+        EXPECT_EQ(i * 10, m.at(i));
+    }
+}
+
+TEST(SmallMapTest, eraseInSmallMode) {
+    Hashmap<int, std::string, std::hash<int>, SmallMapPolicy> m;
+
+    for (int i = 0; i < 6; ++i) {
+        m[i] = std::string(30, 'a' + i);
+    }
+
+    EXPECT_EQ(1, m.erase(0));
+    EXPECT_EQ(0, m.erase(0));
+    EXPECT_EQ(1, m.erase_if([](std::pair<const int, std::string> &p) { return p.first == 3; }));
+
+    // erase the rest while iterating
+    int seen = 0;
+    for (auto it = m.begin(); it != m.end(); ++seen) {
+        EXPECT_EQ(std::string(30, 'a' + it->first), it->second);
+        it = m.erase(it);
+    }
+
+    EXPECT_EQ(4, seen);
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(0, m.bucket_count());
+}
+
+TEST(SmallMapTest, moveKeepsElements) {
+    Hashmap<int, std::string, std::hash<int>, SmallMapPolicy> m;
+
+    for (int i = 0; i < 4; ++i) {
+        m[i] = std::to_string(i);
+    }
+
+    Hashmap<int, std::string, std::hash<int>, SmallMapPolicy> n(std::move(m));
+    EXPECT_EQ(4, n.size());
+    EXPECT_EQ("3", n.at(3));
+}
+
+TEST(MemoryUsageTest, breakdown) {
+    Hashmap<int, int, ZeroHF<int>, ChainedPolicy> m;
+    ASSERT_EQ(0, m.memory_usage().bytes_per_element());
+
+    for (int i = 0; i < 10; ++i) {
+        m[i] = i;
+    }
+
+    // one chain: the tail element, every other element lives in a node
+    MemoryUsage u = m.memory_usage();
+    EXPECT_EQ(10, u.elements);
+    EXPECT_EQ(sizeof(m), u.object_bytes);
+    EXPECT_LE(m.bucket_count() * sizeof(void*), u.bucket_bytes);
+    EXPECT_EQ(1, u.element_pools.objects);
+    EXPECT_EQ(9, u.node_pools.objects);
+    EXPECT_EQ(sizeof(std::pair<const int, int>), u.element_pools.used_bytes);
+    EXPECT_LE(u.element_pools.used_bytes, u.element_pools.reserved_bytes);
+    EXPECT_EQ(u.total_bytes(), u.bytes_per_element() * 10);
+}
+
+struct ChainedStats : ChainedPolicy {
+    using stats = collect_stats;
+};
+
+TEST(StatsTest, disabledCostsNothing) {
+    using plain = Hashmap<int, int, ZeroHF<int>, ChainedPolicy>;
+    using counted = Hashmap<int, int, ZeroHF<int>, ChainedStats>;
+    EXPECT_EQ(sizeof(plain) + sizeof(StatCounters), sizeof(counted));
+
+    plain m;
+    m[1] = 1;
+    MapStats s = m.statistics();
+    EXPECT_FALSE(s.collected);
+    EXPECT_EQ(0, s.lookups);
+    EXPECT_EQ(std::string::npos, s.to_text().find("lookups"));
+}
+
+TEST(StatsTest, countsHotPath) {
+    Hashmap<int, int, ZeroHF<int>, ChainedStats> m(64);
+
+    for (int i = 0; i < 10; ++i) {
+        m[i] = i;
+    }
+
+    MapStats s = m.statistics();
+    EXPECT_TRUE(s.collected);
+    EXPECT_EQ(10, s.lookups);
+    EXPECT_EQ(10, s.misses);
+    EXPECT_EQ(0, s.rehashes);
+    EXPECT_EQ(2, s.pools_created);
+    // the i-th insert searched a chain of i entries
+    EXPECT_EQ(45, s.probes);
+    EXPECT_EQ(9, s.max_probes);
+
+    m.reset_statistics();
+    EXPECT_EQ(1, m.count(9));
+    EXPECT_EQ(0, m.count(10));
+    s = m.statistics();
+    EXPECT_EQ(2, s.lookups);
+    EXPECT_EQ(1, s.hits);
+    EXPECT_EQ(1, s.misses);
+
+    // erasing the tail turns the newest node into an element, and the pool
+    // moves its last node into the hole
+    m.reset_statistics();
+    m.erase(0);
+    EXPECT_EQ(2, m.statistics().erase_fixups);
+
+    m.rehash(1000);
+    s = m.statistics();
+    EXPECT_EQ(1, s.rehashes);
+    EXPECT_LT(0, s.rehash_ns);
+}
+
+TEST(StatsTest, chainHistogram) {
+    Hashmap<int, int, ZeroHF<int>, ChainedPolicy> m(8);
+
+    for (int i = 0; i < 5; ++i) {
+        m[i] = i;
+    }
+
+    // ZeroHF puts everything in bucket 0
+    std::vector<size_t> expected = {7, 0, 0, 0, 0, 1};
+    EXPECT_EQ(expected, m.chain_histogram());
+
+    std::string text = m.statistics().to_text("m_");
+    EXPECT_NE(std::string::npos, text.find("m_chain_length{n=\"5\"} 1\n"));
+}
+
+struct Traced : ChainedPolicy {
+    using trace = trace_ring<64>;
+};
+
+TEST(TraceTest, recordsEvents) {
+    Hashmap<int, int, ZeroHF<int>, Traced> m;
+    EXPECT_TRUE(m.trace_log().events.empty());
+
+    for (int i = 0; i < 10; ++i) {
+        m[i] = i;
+    }
+
+    std::vector<TraceEvent> events = m.trace_log().events;
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(TraceEvent::pool_created, events[0].kind);
+    EXPECT_EQ(TraceEvent::elements, events[0].pool);
+    EXPECT_EQ(0, events[0].a);
+
+    size_t begins = 0, ends = 0, pools = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        begins += events[i].kind == TraceEvent::rehash_begin;
+        ends += events[i].kind == TraceEvent::rehash_end;
+        pools += events[i].kind == TraceEvent::pool_created;
+        if (i) { EXPECT_LE(events[i - 1].ns, events[i].ns); }
+    }
+    EXPECT_LT(0, begins);
+    EXPECT_EQ(begins, ends);
+    EXPECT_EQ(2, pools);
+
+    // erasing the tail moves a node into the element pool, then the last
+    // node into the hole
+    m.clear_trace();
+    m.erase(0);
+    events = m.trace_log().events;
+    ASSERT_EQ(2, events.size());
+    EXPECT_EQ(TraceEvent::element_moved, events[1].kind);
+    EXPECT_EQ(TraceEvent::nodes, events[1].pool);
+
+    m.clear_trace();
+    m.clear();
+    events = m.trace_log().events;
+    ASSERT_EQ(2, events.size());
+    EXPECT_EQ(TraceEvent::pool_released, events[0].kind);
+    EXPECT_EQ(1, events[0].a);
+}
+
+struct ShortTrace : ChainedPolicy {
+    using trace = trace_ring<8>;
+};
+
+TEST(TraceTest, ringKeepsNewest) {
+    Hashmap<int, int, std::hash<int>, ShortTrace> m;
+
+    for (int i = 0; i < 100000; ++i) {
+        m[i] = i;
+    }
+
+    TraceLog log = m.trace_log();
+    EXPECT_EQ(8, log.events.size());
+    EXPECT_LT(0, log.dropped);
+    EXPECT_EQ(TraceEvent::rehash_end, log.events.back().kind);
+    EXPECT_EQ(m.bucket_count(), log.events.back().b);
+
+    std::string chrome = log.to_chrome_trace();
+    EXPECT_EQ(0, chrome.find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, chrome.find("\"name\":\"rehash\",\"ph\":\"E\""));
+    EXPECT_NE(std::string::npos, log.to_json().find("\"event\":\"rehash_end\""));
+}
+
+TEST(TraceTest, disabledCostsNothing) {
+    using plain = Hashmap<int, int, ZeroHF<int>, ChainedPolicy>;
+    using traced = Hashmap<int, int, ZeroHF<int>, Traced>;
+    EXPECT_EQ(sizeof(plain) + sizeof(trace_ring<64>), sizeof(traced));
+
+    plain m;
+    m[1] = 1;
+    EXPECT_EQ("[\n]\n", m.trace_log().to_json());
+}
+
+TEST(GrowthTest, factors) {
+    EXPECT_EQ(3, doubling_growth::next_size(1));
+    EXPECT_EQ(2047, doubling_growth::next_size(1023));
+    EXPECT_EQ(1, doubling_growth::next_size(0));
+
+    // always grows, and always to an odd count
+    EXPECT_EQ(3, (growth_factor<3, 2>::next_size(1)));
+    EXPECT_EQ(151, (growth_factor<3, 2>::next_size(100)));
+    EXPECT_EQ(151, (prime_growth<3, 2>::next_size(100)));
+    EXPECT_EQ(1543, (prime_growth<3, 2>::next_size(1024)));
+    EXPECT_EQ(2053, prime_growth<>::next_size(1024));
+}
+
+TEST(GrowthTest, primeSizes) {
+    Hashmap<int, int, std::hash<int>, PrimePolicy> m;
+    std::vector<size_t> sizes;
+
+    for (int i = 0; i < 5000; ++i) {
+        m[i] = i;
+        if (sizes.empty() || sizes.back() != m.bucket_count()) sizes.push_back(m.bucket_count());
+    }
+
+    EXPECT_LT(8, sizes.size());
+    for (size_t n : sizes) {
+        for (size_t d = 2; d * d <= n; ++d) {
+            ASSERT_NE(0, n % d) << n << " is not prime";
+        }
+    }
+}
+
+TEST(GrowthTest, denseLoad) {
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, DensePolicy> dense;
+    Hashmap<uint64_t, uint64_t> plain;
+    EXPECT_FLOAT_EQ(3, dense.max_load_factor());
+
+    for (uint64_t i = 0; i < 100000; ++i) {
+        dense[i * 7919] = i;
+        plain[i * 7919] = i;
+    }
+
+    EXPECT_LE(2, dense.load_factor());
+    EXPECT_GT(3, dense.load_factor());
+    EXPECT_LT(dense.memory_usage().bucket_bytes * 2, plain.memory_usage().bucket_bytes);
+}
+
+TEST(GrowthTest, modelPicksLoadFactor) {
+    struct ModelChained : ChainedPolicy { using growth = model_growth<>; };
+    struct ModelGrouped : GroupedPolicy { using growth = model_growth<>; };
+    struct ModelCheap : ChainedPolicy { using growth = model_growth<300>; };
+
+    // plain buckets get fewer bytes per entry the fuller they are, so the
+    // cost target decides; groups pay 64 bytes per bucket
+    EXPECT_FLOAT_EQ(1, (Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, ModelChained>().max_load_factor()));
+    EXPECT_FLOAT_EQ(4, (Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, ModelCheap>().max_load_factor()));
+    EXPECT_LT(4, (Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, ModelGrouped>().max_load_factor()));
+
+    // no overflow with one entry per slot, all of it at high load
+    EXPECT_NEAR(0, drtx::overflow_share(0.001, 1), 0.001);
+    EXPECT_NEAR(1, drtx::overflow_share(1000, 1), 0.01);
+    EXPECT_NEAR(std::exp(-1.0), drtx::overflow_share(1, 1), 1e-9);
+}
+
+TEST(BudgetTest, holdsBackGrowth) {
+    Hashmap<uint64_t, uint64_t> free, capped;
+    const size_t n = 200000;
+
+    for (uint64_t i = 0; i < n; ++i) free[i * 7919] = i;
+    EXPECT_FALSE(free.over_budget());
+
+    // room for the pools, but not for the bucket arrays free ended with
+    size_t pools = free.memory_usage().total_bytes() - free.memory_usage().bucket_bytes;
+    capped.set_memory_budget(pools + free.memory_usage().bucket_bytes / 4);
+    EXPECT_EQ(pools + free.memory_usage().bucket_bytes / 4, capped.memory_budget());
+
+    for (uint64_t i = 0; i < n; ++i) capped[i * 7919] = i;
+
+    EXPECT_TRUE(capped.over_budget());
+    EXPECT_LT(capped.bucket_count(), free.bucket_count());
+    EXPECT_LT(capped.max_load_factor(), capped.load_factor());
+    EXPECT_GT(free.memory_usage().total_bytes(), capped.memory_usage().total_bytes());
+    for (uint64_t i = 0; i < n; ++i) ASSERT_EQ(i, capped.at(i * 7919));
+
+    // lifting the budget lets the next growth happen
+    capped.set_memory_budget(0);
+    EXPECT_FALSE(capped.over_budget());
+    capped[n * 7919] = n;
+    EXPECT_FALSE(capped.over_budget());
+    EXPECT_GE(capped.max_load_factor(), capped.load_factor());
+}
+
+TEST(LinearTest, splitsOneBucketAtATime) {
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, LinearPolicy> h;
+    const size_t n = 100000;
+
+    for (uint64_t i = 0; i < n; ++i) {
+        size_t before = h.bucket_count();
+        h[i * 7919] = i;
+        ASSERT_GE(before + 1, h.bucket_count());
+        ASSERT_GE(h.max_load_factor(), h.load_factor());
+    }
+
+    // a bucket is added as soon as the load reaches the maximum
+    EXPECT_GT(1.0 / 64, h.max_load_factor() - h.load_factor());
+    for (uint64_t i = 0; i < n; ++i) ASSERT_EQ(i, h.at(i * 7919));
+    EXPECT_EQ(0, h.count(n * 7919));
+
+    // whole segments, however many buckets are in use
+    using directory = drtx::SegmentedDirectory<drtx::Bucket<uint64_t, std::pair<const uint64_t, uint64_t>>>;
+    size_t segments = (h.bucket_count() + directory::segment_size() - 1) / directory::segment_size();
+    EXPECT_LE(segments * directory::segment_size() * sizeof(void*), h.memory_usage().bucket_bytes);
+    EXPECT_GT((segments + 1) * directory::segment_size() * sizeof(void*), h.memory_usage().bucket_bytes);
+}
+
+TEST(LinearTest, relinksInPlace) {
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, LinearPolicy> h;
+
+    for (uint64_t i = 0; i < 5000; ++i) h[i] = i;
+
+    // a full relink starts a new round from any size
+    h.rehash(12345);
+    EXPECT_EQ(12345, h.bucket_count());
+    for (uint64_t i = 5000; i < 20000; ++i) h[i] = i;
+
+    // erasing most of the map compacts the pools with a relink
+    size_t erased = h.erase_if([](const std::pair<const uint64_t, uint64_t> &p) { return p.first % 8 != 0; });
+    EXPECT_EQ(17500, erased);
+
+    for (uint64_t i = 0; i < 20000; ++i) ASSERT_EQ(i % 8 == 0, h.count(i) == 1);
+
+    // moving hands over the segments and the split state
+    auto moved = std::move(h);
+    for (uint64_t i = 20000; i < 40000; ++i) moved[i] = i;
+    for (uint64_t i = 0; i < 40000; ++i) ASSERT_EQ(i % 8 == 0 || i >= 20000, moved.count(i) == 1);
+}
+
+TEST(LinearTest, splitsChainsEndingInNodes) {
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, LinearPolicy> h;
+    h.max_load_factor(4);
+
+    for (uint64_t i = 0; i < 4000; ++i) h[i] = i;
+
+    // deferred compaction leaves chains ending in a node
+    std::vector<uint64_t> batch;
+    for (uint64_t i = 0; i < 4000; i += 5) batch.push_back(i);
+    EXPECT_EQ(800, h.erase_batch(batch.begin(), batch.end()));
+    EXPECT_EQ(400, h.erase_if([](const std::pair<const uint64_t, uint64_t> &p) { return p.first % 10 == 1; }));
+
+    // both halves of a split may turn a node into their element
+    size_t before = h.bucket_count();
+    for (uint64_t i = 4000; i < 8000; ++i) h[i] = i;
+    EXPECT_LT(before + 100, h.bucket_count());
+
+    auto iterated = [](decltype(h) &m) {
+        size_t n = 0;
+        for (auto it = m.begin(); it != m.end(); ++it) ++n;
+        return n;
+    };
+
+    EXPECT_EQ(6800, h.size());
+    EXPECT_EQ(h.size(), iterated(h));
+
+    // a full relink walks the pools, so emptied nodes would reappear
+    h.rehash(h.bucket_count() * 2);
+    EXPECT_EQ(6800, h.size());
+    EXPECT_EQ(h.size(), iterated(h));
+
+    for (uint64_t i = 0; i < 8000; ++i) ASSERT_EQ(i >= 4000 || (i % 5 != 0 && i % 10 != 1), h.count(i) == 1);
+}
+
+TEST(RehashTest, inPlaceMovesOnlyCollidingElements) {
+    struct InPlace : ChainedStats {
+        using rehash = in_place_rehash;
+    };
+
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, ChainedStats> repacked;
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, InPlace> relinked;
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> keys(5000);
+
+    for (uint64_t &k : keys) {
+        k = rng();
+        repacked[k] = k;
+        relinked[k] = k;
+    }
+
+    size_t nodes = relinked.memory_usage().node_pools.objects;
+    repacked.reset_statistics();
+    relinked.reset_statistics();
+    repacked.rehash(20011);
+    relinked.rehash(20011);
+
+    for (uint64_t k : keys) {
+        ASSERT_EQ(k, relinked.at(k));
+        ASSERT_EQ(k, repacked.at(k));
+    }
+
+    // elements still move into a node when they share a bucket, but
+    // nodes are never turned back into elements
+    EXPECT_LT(0, relinked.statistics().rehash_moves);
+    EXPECT_GT(repacked.statistics().rehash_moves, 2 * relinked.statistics().rehash_moves);
+    EXPECT_LE(nodes, relinked.memory_usage().node_pools.objects);
+    EXPECT_GT(nodes, repacked.memory_usage().node_pools.objects);
+    EXPECT_GT(repacked.memory_usage().element_pools.objects, relinked.memory_usage().element_pools.objects);
+}
+
+TEST(NodeTest, linkPrecedesElement) {
+    using node = drtx::_bNode<std::pair<const uint64_t, std::array<char, 256>>>;
+    node n;
+
+    // the link shares the key's cache line, whatever the value's size
+    EXPECT_EQ(static_cast<void*>(&n), static_cast<void*>(&n.next));
+    EXPECT_EQ(sizeof(void*), node::element_offset());
+    EXPECT_EQ(&n, node::of(&n.element));
+    EXPECT_EQ(static_cast<void*>(&n.element), node::element_of(&n));
+}
+
+struct alignas(16) Wide {
+    uint64_t v;
+    uint64_t pad;
+};
+
+template<typename P>
+void aligned_chains() {
+    using node = drtx::_bNode<std::pair<const uint64_t, Wide>>;
+    static_assert(node::element_offset() == 16, "element of an over-aligned pair");
+
+    Hashmap<uint64_t, Wide, std::hash<uint64_t>, P> h;
+    h.max_load_factor(4.0);
+
+    for (uint64_t i = 0; i < 3000; ++i) h[i].v = i;
+    for (uint64_t i = 0; i < 3000; i += 3) h.erase(i);
+    h.rehash(2 * h.bucket_count());
+
+    ASSERT_EQ(2000u, h.size());
+    for (uint64_t i = 0; i < 3000; ++i) {
+        if (i % 3) {
+            ASSERT_EQ(i, h.at(i).v);
+        } else {
+            ASSERT_EQ(0u, h.count(i));
+        }
+    }
+}
+
+TEST(NodeTest, alignedElements) {
+    aligned_chains<ChainedPolicy>();
+    aligned_chains<StablePolicy>();
+    aligned_chains<GroupedPolicy>();
+    aligned_chains<InPlacePolicy>();
+}
+
+/**
+ * @return true if iteration reads each of the two pools front to back. The
+ * pools are separate allocations, so the widest gap between addresses
+ * tells them apart.
+ */
+template<typename M>
+bool in_bucket_order(M &m) {
+    std::vector<uintptr_t> order;
+    for (auto it = m.begin(); it != m.end(); ++it) {
+        order.push_back(reinterpret_cast<uintptr_t>(&*it));
+    }
+
+    std::vector<uintptr_t> sorted(order);
+    std::sort(sorted.begin(), sorted.end());
+
+    uintptr_t split = sorted.back();
+    for (size_t i = 1, gap = 0; i < sorted.size(); ++i) {
+        if (sorted[i] - sorted[i - 1] > gap) {
+            gap = sorted[i] - sorted[i - 1];
+            split = sorted[i];
+        }
+    }
+
+    uintptr_t low = 0, high = 0;
+    for (uintptr_t p : order) {
+        uintptr_t &last = p < split ? low : high;
+        if (p < last) return false;
+        last = p;
+    }
+    return true;
+}
+
+TEST(LayoutTest, poolsFollowBuckets) {
+    Hashmap<uint64_t, std::string, std::hash<uint64_t>, ChainedPolicy> h;
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> keys(6000);
+
+    for (uint64_t &k : keys) {
+        k = rng();
+        h[k] = std::to_string(k);
+    }
+    for (size_t i = 0; i < keys.size(); i += 2) h.erase(keys[i]);
+
+    ASSERT_EQ(1u, h.memory_usage().element_pools.pools);
+    ASSERT_EQ(1u, h.memory_usage().node_pools.pools);
+    EXPECT_FALSE(in_bucket_order(h));
+
+    size_t buckets = h.bucket_count();
+    h.optimize_layout();
+
+    EXPECT_TRUE(in_bucket_order(h));
+    EXPECT_EQ(buckets, h.bucket_count());
+    EXPECT_EQ(3000u, h.size());
+    for (size_t i = 1; i < keys.size(); i += 2) {
+        ASSERT_EQ(std::to_string(keys[i]), h.at(keys[i]));
+    }
+}
+
+TEST(OccupancyTest, nextSetBit) {
+    std::vector<int> buckets(1000);
+    occupancy_bitmap bits;
+    bits.resize(buckets.size());
+
+    EXPECT_EQ(1000u, bits.next(0));
+
+    for (size_t i : {0, 63, 64, 200, 999}) bits.set(i, true);
+    EXPECT_EQ(0u, bits.next(0));
+    EXPECT_EQ(63u, bits.next(1));
+    EXPECT_EQ(64u, bits.next(64));
+    EXPECT_EQ(200u, bits.next(65));
+    EXPECT_EQ(999u, bits.next(201));
+    EXPECT_EQ(1000u, bits.next(1000));
+
+    bits.set(999, false);
+    EXPECT_EQ(1000u, bits.next(201));
+
+    // dropped buckets don't come back when the bitmap grows again
+    bits.resize(150);
+    bits.resize(1000);
+    EXPECT_EQ(1000u, bits.next(65));
+}
+
+TEST(OccupancyTest, sparseIteration) {
+    Hashmap<uint64_t, uint64_t, std::hash<uint64_t>, OccupancyPolicy> h;
+    h.rehash(50000);
+    using bucket = drtx::Bucket<uint64_t, std::pair<const uint64_t, uint64_t>>;
+    size_t bitmap = h.memory_usage().bucket_bytes - h.bucket_count() * sizeof(bucket);
+
+    for (uint64_t i = 0; i < 5000; ++i) h[i] = i;
+    EXPECT_EQ(5000u, h.erase_if([](std::pair<const uint64_t, uint64_t> &p) { return p.first % 2 == 0; }) * 2);
+    for (uint64_t i = 1; i < 5000; i += 4) h.erase(i);
+
+    uint64_t seen = 0;
+    for (auto it = h.begin(); it != h.end();) {
+        ASSERT_EQ(3u, it->first % 4);
+        // erase half of what is left through the iterator
+        if (it->first % 8 == 3) {
+            it = h.erase(it);
+        } else {
+            ++it;
+        }
+        ++seen;
+    }
+    EXPECT_EQ(1250u, seen);
+    EXPECT_EQ(625u, h.size());
+
+    EXPECT_EQ((h.bucket_count() + 63) / 64 * 8, bitmap);
+    h.clear();
+    EXPECT_TRUE(h.begin() == h.end());
+}
@@ -1,3 +1,4 @@
+#include <string>
 #include "gtest/gtest.h"
 #include "test_utils.hpp"
 #include "dirtyMap/Allocator.hpp"
@@ -115,3 +116,135 @@ TEST_F(StackedPoolTest, fooDestroy) {
     ASSERT_EQ(2, foo_pool.size());
 }
 
+
+TEST_F(StackedPoolTest, releaseFillsHolesFromTop) {
+    // v holds 0..4; free 0, 3 and 4 (the last two already at the top)
+    void *holes[] = { v[0], v[3], v[4] };
+    std::vector<std::pair<void*, void*>> moves;
+
+    full_pool.release(holes, holes + 3, [&](void *from, void *to) {
+        moves.emplace_back(from, to);
+    });
+
+    ASSERT_EQ(2, full_pool.size());
+    ASSERT_EQ(1, moves.size());
+    // only 2 had to move down into the first hole
+    ASSERT_EQ(v[2], moves[0].first);
+    ASSERT_EQ(v[0], moves[0].second);
+    ASSERT_EQ(2, *v[0]);
+    ASSERT_EQ(1, *v[1]);
+}
+
+TEST(StablePoolTest, deallocateLeavesHole) {
+    StablePool<int, five_count> pool;
+    int *p[5];
+
+    for (int i = 0; i < 5; ++i) {
+        p[i] = static_cast<int*>(pool.allocate());
+        *p[i] = i;
+    }
+
+    ASSERT_TRUE(pool.full());
+    ASSERT_EQ(nullptr, pool.destroy(p[1]));
+    ASSERT_EQ(4, pool.size());
+    // nothing moved
+    ASSERT_EQ(4, *p[4]);
+
+    // the hole is reused
+    ASSERT_EQ(p[1], pool.allocate());
+}
+
+TEST(StablePoolTest, iteratorSkipsHoles) {
+    StablePool<int, five_count> pool;
+    int *p[5];
+
+    for (int i = 0; i < 5; ++i) {
+        p[i] = static_cast<int*>(pool.allocate());
+        *p[i] = i;
+    }
+
+    pool.deallocate(p[0]);
+    pool.deallocate(p[3]);
+
+    int seen = 0;
+    for (auto it = pool.begin(); it != pool.end(); ++it) {
+        ASSERT_NE(0, *it);
+        ASSERT_NE(3, *it);
+        ++seen;
+    }
+    ASSERT_EQ(3, seen);
+}
+
+/// Counts live objects, to catch a relocation that skips a destructor.
+struct Tracked {
+    static int live;
+    int v;
+
+    explicit Tracked(int x) : v(x) { ++live; }
+    Tracked(Tracked &&other) noexcept : v(other.v) { ++live; }
+    ~Tracked() { --live; }
+};
+
+int Tracked::live = 0;
+
+TEST(RelocateTest, traits) {
+    EXPECT_TRUE((drtx::trivially_relocatable<std::pair<const uint64_t, uint64_t>>::value));
+    EXPECT_TRUE((drtx::trivially_relocatable<std::pair<const int, std::pair<double, char>>>::value));
+    EXPECT_FALSE((drtx::trivially_relocatable<std::pair<const std::string, int>>::value));
+    EXPECT_FALSE(drtx::trivially_relocatable<Tracked>::value);
+}
+
+TEST(RelocateTest, stackedPoolEndsMovedObjects) {
+    {
+        StackedPool<Tracked, five_count> pool;
+        Tracked *p[5];
+
+        for (int i = 0; i < 5; ++i) {
+            p[i] = new(pool.allocate()) Tracked(i);
+        }
+
+        // 4 moves down into the hole, and its old copy is destroyed
+        pool.destroy(p[1]);
+        EXPECT_EQ(4, Tracked::live);
+        EXPECT_EQ(4, p[1]->v);
+
+        // holding 0 4 2 3: 3 fills the first hole, the second is on top
+        p[0]->~Tracked();
+        p[2]->~Tracked();
+        void *holes[] = { p[0], p[2] };
+        pool.release(holes, holes + 2, [](void*, void*) { });
+
+        EXPECT_EQ(2, Tracked::live);
+        EXPECT_EQ(3, p[0]->v);
+        EXPECT_EQ(4, p[1]->v);
+    }
+
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(RelocateTest, forgetAllSkipsDestructors) {
+    Tracked *moved[3];
+    {
+        StackedPool<Tracked, five_count> stacked;
+        StablePool<Tracked, five_count> stable;
+
+        for (int i = 0; i < 3; ++i) {
+            Tracked *s = new(stacked.allocate()) Tracked(i);
+            moved[i] = static_cast<Tracked*>(stable.allocate());
+            // relocated elsewhere: the pool must not destroy them again
+            drtx::relocate(moved[i], s);
+        }
+
+        EXPECT_EQ(3, Tracked::live);
+        stacked.forgetAll();
+        EXPECT_TRUE(stacked.empty());
+        EXPECT_EQ(3, Tracked::live);
+
+        for (int i = 0; i < 3; ++i) EXPECT_EQ(i, moved[i]->v);
+        for (Tracked *t : moved) t->~Tracked();
+        stable.forgetAll();
+        EXPECT_TRUE(stable.empty());
+    }
+
+    EXPECT_EQ(0, Tracked::live);
+}